@@ -0,0 +1,63 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#ifndef EXECUTION_STATISTICS_H
+#define EXECUTION_STATISTICS_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// ==============================
+// EXECUTION STATISTICS CLASS DEFINITION:
+// Process-wide counters and latency histograms
+// ==============================
+struct QLatencyHistogram
+{
+    QLatencyHistogram();
+    QVector<qint64> buckets;
+    qint64 count;
+    qint64 sum;
+    qint64 maximum;
+};
+
+class QExecutionStatistics
+{
+public:
+    static void increment(QString counter, qint64 value = 1);
+    static void recordExitCode(QString exitCode);
+    static void recordLatency(QString histogram, qint64 milliseconds);
+    static void scriptStarted();
+    static void scriptFinished();
+    static void enqueued(QString queue, qint64 count = 1);
+    static void dequeued(QString queue, qint64 count = 1);
+
+    static QJsonObject toJson();
+    static QString toHtml();
+
+private:
+    static QMap<QString, qint64> counters;
+    static QMap<QString, qint64> exitCodes;
+    static QMap<QString, QLatencyHistogram> histograms;
+    static qint64 scriptsRunning;
+    static qint64 scriptsRunningPeak;
+    static QMap<QString, qint64> queueLengths;
+    static QMap<QString, qint64> queueLengthsPeak;
+};
+
+#endif // EXECUTION_STATISTICS_H
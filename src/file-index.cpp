@@ -0,0 +1,366 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QMimeDatabase>
+
+#include "execution-statistics.h"
+#include "file-index.h"
+
+// ==============================
+// APPLICATION FILE INDEX:
+// ==============================
+QApplicationFileIndex *QApplicationFileIndex::sharedFileIndex = 0;
+
+QIndexedFile::QIndexedFile()
+{
+    exists = false;
+    size = 0;
+}
+
+// The entity tag of a local file is made of its size and
+// modification time, so no file has to be read to compare it:
+QByteArray QIndexedFile::qEntityTag() const
+{
+    return "\""
+            + QByteArray::number(size, 16) + "-"
+            + QByteArray::number(lastModified.toMSecsSinceEpoch(), 16)
+            + "\"";
+}
+
+QFileIndexBuilder::QFileIndexBuilder(QString root)
+    : QThread(0)
+{
+    rootDirectory = root;
+}
+
+QIndexedFile QFileIndexBuilder::qIndexFile(const QFileInfo &fileInfo)
+{
+    QMimeDatabase mimeDatabase;
+
+    QIndexedFile indexedFile;
+    indexedFile.exists = fileInfo.isFile();
+    indexedFile.size = fileInfo.size();
+    indexedFile.lastModified = fileInfo.lastModified();
+    indexedFile.mimeType = mimeDatabase.mimeTypeForFile(fileInfo).name();
+
+    return indexedFile;
+}
+
+void QFileIndexBuilder::run()
+{
+    directories.insert(QDir::cleanPath(rootDirectory),
+                       QHash<QString, QIndexedFile>());
+
+    QDirIterator iterator(rootDirectory,
+                          QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                          QDirIterator::Subdirectories);
+
+    while (iterator.hasNext()) {
+        iterator.next();
+        QFileInfo fileInfo = iterator.fileInfo();
+
+        if (fileInfo.isDir()) {
+            QString directoryPath = QDir::cleanPath(fileInfo.filePath());
+            if (!directories.contains(directoryPath)) {
+                directories.insert(directoryPath,
+                                   QHash<QString, QIndexedFile>());
+            }
+        } else {
+            directories[QDir::cleanPath(fileInfo.path())]
+                    .insert(fileInfo.fileName(), qIndexFile(fileInfo));
+        }
+    }
+}
+
+QApplicationFileIndex::QApplicationFileIndex(QString root)
+    : QObject(0)
+{
+    rootDirectory = root;
+    fileCount = 0;
+    ready = false;
+    sharedFileIndex = this;
+
+    QObject::connect(&watcher, SIGNAL(directoryChanged(QString)),
+                     this, SLOT(qDirectoryChangedSlot(QString)));
+    QObject::connect(&watcher, SIGNAL(fileChanged(QString)),
+                     this, SLOT(qFileChangedSlot(QString)));
+
+    builder = new QFileIndexBuilder(rootDirectory);
+    QObject::connect(builder, SIGNAL(finished()),
+                     this, SLOT(qIndexBuiltSlot()));
+    builder->start(QThread::LowPriority);
+}
+
+QApplicationFileIndex::~QApplicationFileIndex()
+{
+    if (builder != 0) {
+        builder->wait();
+        delete builder;
+    }
+
+    sharedFileIndex = 0;
+}
+
+QApplicationFileIndex *QApplicationFileIndex::qSharedFileIndex()
+{
+    return sharedFileIndex;
+}
+
+bool QApplicationFileIndex::isReady()
+{
+    return ready;
+}
+
+// All paths are normalized - separators are always '/'.
+// File names are case-insensitive on Windows:
+QString QApplicationFileIndex::qKey(QString path)
+{
+#ifdef Q_OS_WIN
+    return QDir::cleanPath(path).toLower();
+#else
+    return QDir::cleanPath(path);
+#endif
+}
+
+// Returns the indexed file or the file from the disk,
+// if the index is not available yet or the file is not watched:
+QIndexedFile QApplicationFileIndex::qFile(QString path)
+{
+    QString filePath = qKey(path);
+    int separator = filePath.lastIndexOf('/');
+    QString directoryKey = filePath.left(separator);
+
+    if (sharedFileIndex == 0 or sharedFileIndex->ready == false or
+            sharedFileIndex->unwatchedDirectories.contains(directoryKey) or
+            sharedFileIndex->unwatchedFiles.contains(filePath)) {
+        QExecutionStatistics::increment("file-index-misses");
+        return QFileIndexBuilder::qIndexFile(QFileInfo(path));
+    }
+
+    QIndexedFile file = sharedFileIndex->directories.value(directoryKey)
+            .value(filePath.mid(separator + 1));
+
+    if (file.exists == true and
+            !sharedFileIndex->watchedFiles.contains(filePath) and
+            !sharedFileIndex->rootDirectory.startsWith(":")) {
+        QExecutionStatistics::increment("file-index-misses");
+        return sharedFileIndex->qWatchFile(path);
+    }
+
+    QExecutionStatistics::increment("file-index-hits");
+    return file;
+}
+
+// A file is watched from its first lookup on and is indexed again,
+// because it could have been rewritten in place before:
+QIndexedFile QApplicationFileIndex::qWatchFile(QString path)
+{
+    QString filePath = QDir::cleanPath(path);
+    int separator = filePath.lastIndexOf('/');
+    QString directoryKey = qKey(filePath.left(separator));
+    QString fileKey = qKey(filePath.mid(separator + 1));
+
+    if (watcher.addPath(filePath)) {
+        watchedFiles.insert(qKey(filePath));
+    } else {
+        unwatchedFiles.insert(qKey(filePath));
+        QExecutionStatistics::increment("file-index-unwatched-files");
+    }
+
+    QIndexedFile file = QFileIndexBuilder::qIndexFile(QFileInfo(filePath));
+    if (file.exists == true) {
+        directories[directoryKey].insert(fileKey, file);
+    }
+
+    return file;
+}
+
+void QApplicationFileIndex::qIndexBuiltSlot()
+{
+    QHashIterator<QString, QHash<QString, QIndexedFile> >
+            directory(builder->directories);
+    while (directory.hasNext()) {
+        directory.next();
+
+        QHash<QString, QIndexedFile> directoryFiles;
+        QHashIterator<QString, QIndexedFile> file(directory.value());
+        while (file.hasNext()) {
+            file.next();
+            directoryFiles.insert(qKey(file.key()), file.value());
+        }
+
+        directories.insert(qKey(directory.key()), directoryFiles);
+        fileCount = fileCount + directoryFiles.size();
+    }
+
+    // Files in a packed application archive can not change:
+    if (!rootDirectory.startsWith(":")) {
+        qWatchDirectories(builder->directories.keys());
+    }
+
+    ready = true;
+
+    qDebug() << QDateTime::currentMSecsSinceEpoch()
+             << "msecs from epoch:"
+             << "application file index built:"
+             << fileCount << "files,"
+             << directories.size() << "directories.";
+
+    builder->deleteLater();
+    builder = 0;
+}
+
+// Directories which can not be watched - for example when
+// the watch limit of the operating system is reached -
+// are not served from the index, but from the disk:
+void QApplicationFileIndex::qWatchDirectories(QStringList paths)
+{
+    QStringList unwatchedPaths = watcher.addPaths(paths);
+
+    foreach (QString path, unwatchedPaths) {
+        unwatchedDirectories.insert(qKey(path));
+    }
+
+    if (unwatchedPaths.length() > 0) {
+        QExecutionStatistics::increment("file-index-unwatched-directories");
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "application directories not watched:"
+                 << unwatchedPaths.length() << "- first one:"
+                 << unwatchedPaths.first();
+    }
+}
+
+// Files in the directory are added, removed or replaced -
+// only the changed directory is indexed again:
+void QApplicationFileIndex::qDirectoryChangedSlot(QString path)
+{
+    if (QDir(path).exists()) {
+        qIndexDirectory(path);
+        return;
+    }
+
+    // A removed directory is removed with all its subdirectories:
+    QString directoryKey = qKey(path);
+
+    QMutableHashIterator<QString, QHash<QString, QIndexedFile> >
+            directory(directories);
+    while (directory.hasNext()) {
+        directory.next();
+        if (directory.key() == directoryKey or
+                directory.key().startsWith(directoryKey + "/")) {
+            fileCount = fileCount - directory.value().size();
+            if (directory.value().size() > 0) {
+                emit fileChangedSignal(directory.key());
+            }
+
+            foreach (QString fileKey, directory.value().keys()) {
+                watchedFiles.remove(directory.key() + "/" + fileKey);
+                unwatchedFiles.remove(directory.key() + "/" + fileKey);
+            }
+
+            directory.remove();
+        }
+    }
+
+    unwatchedDirectories.remove(directoryKey);
+}
+
+void QApplicationFileIndex::qIndexDirectory(QString path)
+{
+    QString directoryKey = qKey(path);
+    QHash<QString, QIndexedFile> oldFiles = directories.value(directoryKey);
+    QHash<QString, QIndexedFile> newFiles;
+
+    QDir directory(path);
+    foreach (QFileInfo fileInfo,
+             directory.entryInfoList(QDir::Files | QDir::Dirs |
+                                     QDir::NoDotAndDotDot)) {
+        QString filePath = QDir::cleanPath(fileInfo.filePath());
+
+        if (fileInfo.isDir()) {
+            if (!directories.contains(qKey(filePath))) {
+                directories.insert(qKey(filePath),
+                                   QHash<QString, QIndexedFile>());
+                qWatchDirectories(QStringList() << filePath);
+                qIndexDirectory(filePath);
+            }
+        } else {
+            QString fileKey = qKey(fileInfo.fileName());
+            QIndexedFile newFile = QFileIndexBuilder::qIndexFile(fileInfo);
+            QIndexedFile oldFile = oldFiles.value(fileKey);
+
+            if (oldFile.exists == false or
+                    oldFile.size != newFile.size or
+                    oldFile.lastModified != newFile.lastModified) {
+                emit fileChangedSignal(filePath);
+            }
+
+            newFiles.insert(fileKey, newFile);
+            oldFiles.remove(fileKey);
+        }
+    }
+
+    // Files left in the old index are removed:
+    foreach (QString fileKey, oldFiles.keys()) {
+        watchedFiles.remove(directoryKey + "/" + fileKey);
+        unwatchedFiles.remove(directoryKey + "/" + fileKey);
+        emit fileChangedSignal(directoryKey + "/" + fileKey);
+    }
+
+    fileCount = fileCount - directories.value(directoryKey).size()
+            + newFiles.size();
+    directories.insert(directoryKey, newFiles);
+}
+
+// File contents are changed - also when they are rewritten in place:
+void QApplicationFileIndex::qFileChangedSlot(QString path)
+{
+    QString filePath = QDir::cleanPath(path);
+    int separator = filePath.lastIndexOf('/');
+    QString directoryKey = qKey(filePath.left(separator));
+    QString fileKey = qKey(filePath.mid(separator + 1));
+
+    QFileInfo fileInfo(filePath);
+
+    if (fileInfo.exists()) {
+        if (!directories.value(directoryKey).contains(fileKey)) {
+            fileCount++;
+        }
+        directories[directoryKey].insert(
+                    fileKey, QFileIndexBuilder::qIndexFile(fileInfo));
+
+        // Files replaced by editors are not watched anymore:
+        if (!watcher.files().contains(filePath) and
+                !watcher.addPath(filePath)) {
+            watchedFiles.remove(qKey(filePath));
+            unwatchedFiles.insert(qKey(filePath));
+        }
+    } else {
+        if (directories.contains(directoryKey) and
+                directories[directoryKey].remove(fileKey) > 0) {
+            fileCount--;
+        }
+        watchedFiles.remove(qKey(filePath));
+    }
+
+    emit fileChangedSignal(qKey(filePath));
+}
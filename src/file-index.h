@@ -0,0 +1,110 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#ifndef FILE_INDEX_H
+#define FILE_INDEX_H
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+// ==============================
+// APPLICATION FILE INDEX CLASS DEFINITION:
+// ==============================
+// All files of the application directory are indexed
+// on a background thread at startup and the index is kept current
+// using a file system watcher.
+// All directories are watched for added, removed or replaced files.
+// Directory watches do not report files rewritten in place, so
+// every file is also watched from its first lookup on.
+// The index is keyed by directory, so that a changed directory is
+// indexed again without scanning all files.
+// Until the index is built, all lookups go to the disk.
+struct QIndexedFile
+{
+    QIndexedFile();
+    QByteArray qEntityTag() const;
+
+    bool exists;
+    qint64 size;
+    QDateTime lastModified;
+    QString mimeType;
+};
+
+class QFileIndexBuilder : public QThread
+{
+    Q_OBJECT
+
+public:
+    QFileIndexBuilder(QString root);
+    static QIndexedFile qIndexFile(const QFileInfo &fileInfo);
+
+    // Directory path -> file name -> file:
+    QHash<QString, QHash<QString, QIndexedFile> > directories;
+
+protected:
+    void run();
+
+private:
+    QString rootDirectory;
+};
+
+class QApplicationFileIndex : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void fileChangedSignal(QString path);
+
+public slots:
+    void qIndexBuiltSlot();
+    void qDirectoryChangedSlot(QString path);
+    void qFileChangedSlot(QString path);
+
+public:
+    QApplicationFileIndex(QString root);
+    ~QApplicationFileIndex();
+
+    static QApplicationFileIndex *qSharedFileIndex();
+    static QIndexedFile qFile(QString path);
+    bool isReady();
+
+private:
+    static QString qKey(QString path);
+    void qWatchDirectories(QStringList paths);
+    QIndexedFile qWatchFile(QString path);
+    void qIndexDirectory(QString path);
+
+    QString rootDirectory;
+    QFileIndexBuilder *builder;
+    QFileSystemWatcher watcher;
+    QHash<QString, QHash<QString, QIndexedFile> > directories;
+    QSet<QString> unwatchedDirectories;
+    QSet<QString> watchedFiles;
+    QSet<QString> unwatchedFiles;
+    int fileCount;
+    bool ready;
+
+    static QApplicationFileIndex *sharedFileIndex;
+};
+
+#endif // FILE_INDEX_H
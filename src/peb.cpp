@@ -24,8 +24,8 @@
 #include "peb.h"
 
 #ifndef Q_OS_WIN
-#if ADMIN_PRIVILEGES_CHECK == 1 or PERL_DEBUGGER_INTERACTION == 1
-#include <unistd.h> // for geteuid() and isatty()
+#if ADMIN_PRIVILEGES_CHECK == 1
+#include <unistd.h> // for geteuid()
 #endif
 #endif
 
@@ -35,6 +35,10 @@
 #endif
 #endif
 
+#ifndef Q_OS_WIN
+#include <sys/resource.h> // for setrlimit()
+#endif
+
 // ==============================
 // WINDOWS USER PRIVILEGES DETECTION SUBROUTINE:
 // ==============================
@@ -116,8 +120,13 @@ void customMessageHandler(QtMsgType type,
 // ==============================
 int main(int argc, char **argv)
 {
+    // Startup phases are measured from the very beginning of main():
+    QStartupTimer startupTimer;
+
     QApplication application(argc, argv);
 
+    startupTimer.finishPhase("application");
+
     // ==============================
     // BASIC APPLICATION VARIABLES:
     // ==============================
@@ -130,6 +139,26 @@ int main(int argc, char **argv)
     // ==============================
     QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF8"));
 
+    // ==============================
+    // SINGLE INSTANCE MODE:
+    // ==============================
+    // The first command-line argument or the start page is opened
+    // in a new window of an already running instance:
+#if SINGLE_INSTANCE == 1
+    QInstanceServer instanceServer;
+
+    QString instanceRequest;
+    if (application.arguments().length() > 1) {
+        instanceRequest = application.arguments().at(1);
+    }
+
+    if (instanceServer.qForwardRequest(instanceRequest)) {
+        return 0;
+    }
+
+    instanceServer.qListen();
+#endif
+
     // ==============================
     // USER PRIVILEGES DETECTION:
     // ==============================
@@ -151,49 +180,6 @@ int main(int argc, char **argv)
         startedAsRoot = true;
     }
 #endif
-#endif
-
-    // ==============================
-    // START FROM TERMINAL DETECTION:
-    // ==============================
-    // If the browser is started from terminal,
-    // it will start another copy of itself and close the first one.
-    // This is necessary for a working interaction with the Perl debugger on
-    // all Unix-like operating systems.
-#ifndef Q_OS_WIN
-#if PERL_DEBUGGER_INTERACTION == 1
-    if (isatty(fileno(stdin))) {
-        // Fork another instance of the browser:
-        int pid = fork();
-        if (pid < 0) {
-            return 1;
-            QApplication::exit();
-        }
-
-        if (pid == 0) {
-            // Detach all standard I/O descriptors:
-            close(0);
-            close(1);
-            close(2);
-
-            // Enter a new session:
-            setsid();
-
-            // New instance is now detached from terminal:
-            QProcess anotherInstance;
-            anotherInstance.startDetached(
-                        QApplication::applicationFilePath());
-            if (anotherInstance.waitForStarted(-1)) {
-                return 1;
-                QApplication::exit();
-            }
-        } else {
-            // The parent instance should be closed now:
-            return 1;
-            QApplication::exit();
-        }
-    }
-#endif
 #endif
 
     // ==============================
@@ -223,32 +209,18 @@ int main(int argc, char **argv)
     perlExecutable = "perl.exe";
 #endif
 
-    QString perlInterpreterFullPath;
     QString privatePerlInterpreterFullPath = QDir::toNativeSeparators(
                 binaryDirName + QDir::separator()
                 + "perl" + QDir::separator()
                 + "bin" + QDir::separator()
                 + perlExecutable);
 
-    QFile privatePerlInterpreterFile(privatePerlInterpreterFullPath);
-    if (!privatePerlInterpreterFile.exists()) {
-        // Find the full path to the Perl interpreter on PATH:
-        QProcess systemPerlTester;
-        systemPerlTester.start("perl",
-                               QStringList()
-                               << "-e"
-                               << "print $^X;");
-
-        QByteArray testingScriptResultArray;
-        if (systemPerlTester.waitForFinished()) {
-            testingScriptResultArray = systemPerlTester.readAllStandardOutput();
-        }
-        perlInterpreterFullPath = QString::fromLatin1(testingScriptResultArray);
-    } else {
-        perlInterpreterFullPath = privatePerlInterpreterFullPath;
-    }
+    // The Perl interpreter on PATH is searched for in the background
+    // while the main window is created:
+    QPerlInterpreterLocator perlInterpreterLocator(
+                privatePerlInterpreterFullPath);
 
-    application.setProperty("perlInterpreter", perlInterpreterFullPath);
+    startupTimer.finishPhase("perl-interpreter-lookup");
 
     // ==============================
     // APPLICATION DIRECTORY:
@@ -258,8 +230,25 @@ int main(int argc, char **argv)
                 + "resources" + QDir::separator()
                 + "app");
 
+    // A packed application archive is preferred to
+    // the application directory:
+    QString applicationArchiveName = QDir::toNativeSeparators(
+                binaryDirName + QDir::separator()
+                + "resources" + QDir::separator()
+                + "app.rcc");
+
+    if (QFile(applicationArchiveName).exists() and
+            QApplicationArchive::qRegister(applicationArchiveName)) {
+        applicationDirName = QApplicationArchive::qRoot();
+        QApplicationArchive::qStartExtraction();
+    }
+
     application.setProperty("application", applicationDirName);
 
+    // All files of the application directory are indexed
+    // on a background thread:
+    QApplicationFileIndex applicationFileIndex(applicationDirName);
+
     // ==============================
     // APPLICATION ICON:
     // ==============================
@@ -280,18 +269,19 @@ int main(int argc, char **argv)
         QApplication::setWindowIcon(icon);
     }
 
+    startupTimer.finishPhase("application-icon");
+
     // ==============================
     // TRUSTED DOMAINS:
     // ==============================
     QString trustedDomainsFilePath =
-            applicationDirName + QDir::separator() + "trusted-domains.json";
+            QApplicationArchive::qFilePath("/trusted-domains.json");
     QFile trustedDomainsFile(trustedDomainsFilePath);
     QStringList trustedDomainsList;
 
     if (trustedDomainsFile.exists()) {
-        QFileReader *resourceReader =
-                new QFileReader(QString(trustedDomainsFilePath));
-        QString trustedDomainsContents = resourceReader->fileContents;
+        QFileReader resourceReader(trustedDomainsFilePath);
+        QString trustedDomainsContents = resourceReader.fileContents;
 
         QJsonDocument trustedDomainsJsonDocument =
                 QJsonDocument::fromJson(trustedDomainsContents.toUtf8());
@@ -314,7 +304,9 @@ int main(int argc, char **argv)
     }
 
     trustedDomainsList.append(PSEUDO_DOMAIN);
-    application.setProperty("trustedDomains", trustedDomainsList);
+    QTrustedDomains::setDomains(trustedDomainsList);
+
+    startupTimer.finishPhase("trusted-domains");
 
     // ==============================
     // LOGGING:
@@ -367,6 +359,95 @@ int main(int argc, char **argv)
     QObject::connect(qApp, SIGNAL(aboutToQuit()),
                      &exitHandler, SLOT(qExitApplicationSlot()));
 
+    startupTimer.finishPhase("main-window");
+
+    // ==============================
+    // FIRST PAINT AND START PAGE:
+    // ==============================
+    // The embedded loading page is displayed in a maximized window
+    // as soon as possible and the start page is loaded after
+    // the loading page is painted and the Perl interpreter is known:
+    mainWindow.setCentralWidget(mainWindow.webViewWidget);
+    mainWindow.setWindowIcon(icon);
+
+    QStartPageLoader startPageLoader;
+    startPageLoader.window = mainWindow.webViewWidget;
+    startPageLoader.startupTimer = &startupTimer;
+    startPageLoader.privateInterpreter = privatePerlInterpreterFullPath;
+    startPageLoader.trustedDomains = trustedDomainsList;
+    startPageLoader.startedAsRoot = startedAsRoot;
+
+    if (applicationDirName == QApplicationArchive::qRoot()) {
+        startPageLoader.applicationArchive = applicationArchiveName;
+    }
+
+    if (perlInterpreterLocator.isSearching()) {
+        QObject::connect(&perlInterpreterLocator,
+                         SIGNAL(interpreterFoundSignal(QString)),
+                         &startPageLoader,
+                         SLOT(qInterpreterFoundSlot(QString)));
+    } else {
+        startPageLoader.qInterpreterFoundSlot(
+                    perlInterpreterLocator.interpreter);
+    }
+
+    startPageLoader.qStart();
+    mainWindow.showMaximized();
+
+    // The first spare window is prepared when startup is over:
+    QTimer::singleShot(SPARE_WINDOW_DELAY, mainWindow.webViewWidget,
+                       SLOT(qPrepareSpareWindowSlot()));
+
+    return application.exec();
+}
+
+// ==============================
+// START PAGE LOADER:
+// ==============================
+QStartPageLoader::QStartPageLoader()
+    : QObject(0)
+{
+    window = 0;
+    startupTimer = 0;
+    startedAsRoot = false;
+
+    interpreterFound = false;
+    loadingPageLoaded = false;
+    paintReceived = false;
+    firstPainted = false;
+
+    firstPaintTimer.setSingleShot(true);
+    QObject::connect(&firstPaintTimer, SIGNAL(timeout()),
+                     this, SLOT(qFirstPaintSlot()));
+}
+
+// The loading page is set and the first paint is awaited
+// in the event loop of the application:
+void QStartPageLoader::qStart()
+{
+    QObject::connect(window, SIGNAL(loadFinished(bool)),
+                     this, SLOT(qLoadingPageLoadedSlot(bool)));
+    window->installEventFilter(this);
+
+    window->setHtml(QWebViewWidget::qLoadingPageContents());
+
+    firstPaintTimer.start(FIRST_PAINT_TIMEOUT);
+}
+
+void QStartPageLoader::qLoadStartPage()
+{
+    QString perlInterpreterFullPath = interpreter;
+
+    startupTimer->finishPhase("perl-interpreter-wait");
+
+    // The loading page is not reported, even if it is not loaded yet:
+    QObject::disconnect(window, SIGNAL(loadFinished(bool)),
+                        this, SLOT(qLoadingPageLoadedSlot(bool)));
+
+    // The timing report is logged when the start or error page is loaded:
+    QObject::connect(window, SIGNAL(loadFinished(bool)),
+                     startupTimer, SLOT(qStartPageLoadedSlot(bool)));
+
     // ==============================
     // STARTED WITH
     // ADMINISTRATIVE PRIVILEGES
@@ -374,21 +455,16 @@ int main(int argc, char **argv)
     // ==============================
 #if ADMIN_PRIVILEGES_CHECK == 1
     if (startedAsRoot == true) {
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/html/error.html"));
-        QString htmlErrorContents = resourceReader->fileContents;
-
         QString errorMessage = "Using "
-                + application.applicationName().toLatin1() + " "
-                + application.applicationVersion().toLatin1() + " "
+                + qApp->applicationName().toLatin1() + " "
+                + qApp->applicationVersion().toLatin1() + " "
                 + "with administrative privileges is not allowed.";
-        htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
 
-        mainWindow.webViewWidget->setHtml(htmlErrorContents);
+        window->setHtml(QPageTemplate::qErrorPage(errorMessage));
 
         qDebug() << "Using"
-                 << application.applicationName().toLatin1().constData()
-                 << application.applicationVersion().toLatin1().constData()
+                 << qApp->applicationName().toLatin1().constData()
+                 << qApp->applicationVersion().toLatin1().constData()
                  << "with administrative privileges is not allowed.";
     }
 #endif
@@ -396,23 +472,19 @@ int main(int argc, char **argv)
     // ==============================
     // MISSING PERL INTERPRETER ERROR MESSAGE:
     // ==============================
-    if (perlInterpreterFullPath.length() == 0) {
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/html/error.html"));
-        QString htmlErrorContents = resourceReader->fileContents;
 
-        QString errorMessage = privatePerlInterpreterFullPath + "<br>"
+    if (perlInterpreterFullPath.length() == 0) {
+        QString errorMessage = privateInterpreter + "<br>"
                 + "is not found and "
                 + "no Perl interpreter is available on PATH.";
-        htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
 
-        mainWindow.webViewWidget->setHtml(htmlErrorContents);
+        window->setHtml(QPageTemplate::qErrorPage(errorMessage));
 
-        qDebug() << application.applicationName().toLatin1().constData()
-                 << application.applicationVersion().toLatin1().constData()
+        qDebug() << qApp->applicationName().toLatin1().constData()
+                 << qApp->applicationVersion().toLatin1().constData()
                  << "started.";
         qDebug() << "Qt version:" << QT_VERSION_STR;
-        qDebug() << "Executable:" << application.applicationFilePath();
+        qDebug() << "Executable:" << qApp->applicationFilePath();
         qDebug() << "No Perl interpreter is found.";
     }
 
@@ -420,11 +492,11 @@ int main(int argc, char **argv)
         // ==============================
         // LOG BASIC PROGRAM INFORMATION AND SETTINGS:
         // ==============================
-        qDebug() << application.applicationName().toLatin1().constData()
-                 << application.applicationVersion().toLatin1().constData()
+        qDebug() << qApp->applicationName().toLatin1().constData()
+                 << qApp->applicationVersion().toLatin1().constData()
                  << "started.";
         qDebug() << "Qt version:" << QT_VERSION_STR;
-        qDebug() << "Executable:" << application.applicationFilePath();
+        qDebug() << "Executable:" << qApp->applicationFilePath();
 
 #if ADMIN_PRIVILEGES_CHECK == 0
         qDebug() << "Administrative privileges check is disabled.";
@@ -442,11 +514,23 @@ int main(int argc, char **argv)
         qDebug() << "Perl debugger interaction is enabled.";
 #endif
 
+#if PERL_PROFILER_INTERACTION == 0
+        qDebug() << "Perl profiler interaction is disabled.";
+#endif
+
+#if PERL_PROFILER_INTERACTION == 1
+        qDebug() << "Perl profiler interaction is enabled.";
+#endif
+
         qDebug() << "Perl interpreter:" << perlInterpreterFullPath;
 
+        if (applicationArchive.length() > 0) {
+            qDebug() << "Application archive:" << applicationArchive;
+        }
+
         qDebug()  <<"Local pseudo-domain:" << PSEUDO_DOMAIN;
 
-        foreach (QString trustedDomain, trustedDomainsList) {
+        foreach (QString trustedDomain, trustedDomains) {
             if (trustedDomain != PSEUDO_DOMAIN) {
                 qDebug() << "Trusted domain:" << trustedDomain;
             }
@@ -457,42 +541,33 @@ int main(int argc, char **argv)
         // ==============================
         QString startPage;
         QFile staticStartPageFile(
-                    applicationDirName + QDir::separator() + "index.html");
+                QApplicationArchive::qFilePath("/index.html"));
 
         if (staticStartPageFile.exists()) {
             startPage = "http://" + QString(PSEUDO_DOMAIN) + "/index.html";
 
-            application.setProperty("startPage", startPage);
+            qApp->setProperty("startPage", startPage);
 
-            mainWindow.webViewWidget->setUrl(QUrl(startPage));
+            window->setUrl(QUrl(startPage));
         } else {
             QFile dynamicStartPageFile(
-                        applicationDirName + QDir::separator() + "index.pl");
+                        QApplicationArchive::qFilePath("/index.pl"));
             if (dynamicStartPageFile.exists()) {
                 startPage = "http://" + QString(PSEUDO_DOMAIN) + "/index.pl";
 
-                application.setProperty("startPage", startPage);
+                qApp->setProperty("startPage", startPage);
 
-                mainWindow.webViewWidget->setUrl(QUrl(startPage));
+                window->setUrl(QUrl(startPage));
             } else {
-                QFileReader *resourceReader =
-                        new QFileReader(QString(":/html/error.html"));
-                QString htmlErrorContents = resourceReader->fileContents;
-
                 QString errorMessage = "No start page is found.";
-                htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
-                mainWindow.webViewWidget->setHtml(htmlErrorContents);
+                window->setHtml(QPageTemplate::qErrorPage(errorMessage));
 
                 qDebug() << "No start page is found.";
             }
         }
     }
 
-    mainWindow.setCentralWidget(mainWindow.webViewWidget);
-    mainWindow.setWindowIcon(icon);
-    mainWindow.showMaximized();
-
-    return application.exec();
+    startupTimer->finishPhase("start-page-resolution");
 }
 
 // ==============================
@@ -502,6 +577,8 @@ int main(int argc, char **argv)
 QFileReader::QFileReader(QString filePath)
     : QObject(0)
 {
+    QLiveObjects::created("QFileReader");
+
     QString fileName(filePath);
     QFile file(fileName);
     file.open(QIODevice::ReadOnly | QIODevice::Text);
@@ -510,107 +587,1927 @@ QFileReader::QFileReader(QString filePath)
     file.close();
 }
 
+QFileReader::~QFileReader()
+{
+    QLiveObjects::destroyed("QFileReader");
+}
+
 // ==============================
-// MAIN WINDOW CLASS CONSTRUCTOR:
+// PAGE TEMPLATES:
 // ==============================
-QMainBrowserWindow::QMainBrowserWindow(QWidget *parent)
-    : QMainWindow(parent)
+QHash<QString, QParsedTemplate> QPageTemplate::templates;
+
+// Every built-in page is read and split at its placeholder only once,
+// rendering concatenates its chunks and values in a pre-sized buffer:
+QString QPageTemplate::qRender(QString resourcePath,
+                               QString placeholder,
+                               QString value)
 {
-    // !!! No need to implement code here, but must be declared !!!
+    QString templateKey = resourcePath + "|" + placeholder;
+
+    if (!templates.contains(templateKey)) {
+        QFileReader resourceReader(resourcePath);
+
+        QParsedTemplate parsedTemplate;
+        if (placeholder.length() > 0) {
+            parsedTemplate.chunks =
+                    resourceReader.fileContents.split(placeholder);
+        } else {
+            parsedTemplate.chunks.append(resourceReader.fileContents);
+        }
+
+        parsedTemplate.staticLength = 0;
+        foreach (QString chunk, parsedTemplate.chunks) {
+            parsedTemplate.staticLength += chunk.length();
+        }
+
+        templates.insert(templateKey, parsedTemplate);
+    }
+
+    const QParsedTemplate &parsedTemplate = templates[templateKey];
+
+    QString page;
+    page.reserve(parsedTemplate.staticLength +
+                 (parsedTemplate.chunks.length() - 1) * value.length());
+
+    for (int index = 0; index < parsedTemplate.chunks.length(); index++) {
+        if (index > 0) {
+            page.append(value);
+        }
+        page.append(parsedTemplate.chunks.at(index));
+    }
+
+    return page;
+}
+
+QString QPageTemplate::qErrorPage(QString errorMessage)
+{
+    return qRender(":/html/error.html", "ERROR_MESSAGE", errorMessage);
 }
 
 // ==============================
-// CUSTOM NETWORK REPLY CONSTRUCTOR:
+// EXECUTION STATISTICS:
 // ==============================
-struct QCustomNetworkReplyPrivate
-{
-    QByteArray data;
-    int offset;
+// Upper bounds of the latency histogram buckets in milliseconds,
+// the last bucket collects all longer durations:
+static const qint64 latencyBucketBounds[] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500,
+    1000, 2000, 5000, 10000, 30000, 60000
 };
+static const int latencyBucketBoundsCount =
+        sizeof(latencyBucketBounds) / sizeof(latencyBucketBounds[0]);
+
+QMap<QString, qint64> QExecutionStatistics::counters;
+QMap<QString, qint64> QExecutionStatistics::exitCodes;
+QMap<QString, QLatencyHistogram> QExecutionStatistics::histograms;
+qint64 QExecutionStatistics::scriptsRunning = 0;
+qint64 QExecutionStatistics::scriptsRunningPeak = 0;
+QMap<QString, qint64> QExecutionStatistics::queueLengths;
+QMap<QString, qint64> QExecutionStatistics::queueLengthsPeak;
+
+QLatencyHistogram::QLatencyHistogram()
+    : buckets(latencyBucketBoundsCount + 1, 0),
+      count(0),
+      sum(0),
+      maximum(0)
+{
+}
 
-QCustomNetworkReply::QCustomNetworkReply(
-        const QUrl &url, const QString &data, const QString &mime)
-    : QNetworkReply()
+void QExecutionStatistics::increment(QString counter, qint64 value)
 {
-    setFinished(true);
-    open(ReadOnly | Unbuffered);
+    counters[counter] += value;
+}
 
-    reply = new QCustomNetworkReplyPrivate;
-    reply->offset = 0;
+void QExecutionStatistics::recordExitCode(QString exitCode)
+{
+    exitCodes[exitCode] += 1;
+}
 
-    setUrl(url);
+void QExecutionStatistics::recordLatency(QString histogram,
+                                         qint64 milliseconds)
+{
+    QLatencyHistogram &latencyHistogram = histograms[histogram];
 
-    if (data.length() > 0) {
-        setHeader(QNetworkRequest::ContentLengthHeader,
-                  QVariant(reply->data.size()));
-        setHeader(QNetworkRequest::LastModifiedHeader,
-                  QVariant(QDateTime::currentDateTimeUtc()));
-        setHeader(QNetworkRequest::ContentTypeHeader, mime);
+    int bucket = 0;
+    while (bucket < latencyBucketBoundsCount and
+           milliseconds > latencyBucketBounds[bucket]) {
+        bucket++;
+    }
+
+    latencyHistogram.buckets[bucket] += 1;
+    latencyHistogram.count += 1;
+    latencyHistogram.sum += milliseconds;
+    latencyHistogram.maximum = qMax(latencyHistogram.maximum, milliseconds);
+}
+
+void QExecutionStatistics::scriptStarted()
+{
+    scriptsRunning++;
+    scriptsRunningPeak = qMax(scriptsRunningPeak, scriptsRunning);
+}
+
+void QExecutionStatistics::scriptFinished()
+{
+    if (scriptsRunning > 0) {
+        scriptsRunning--;
+    }
+}
+
+// Queues of the same name are added together - for example
+// the queues of profiled scripts of all pages:
+void QExecutionStatistics::enqueued(QString queue, qint64 count)
+{
+    queueLengths[queue] += count;
+    queueLengthsPeak[queue] =
+            qMax(queueLengthsPeak.value(queue), queueLengths.value(queue));
+}
+
+void QExecutionStatistics::dequeued(QString queue, qint64 count)
+{
+    queueLengths[queue] = qMax((qint64) 0, queueLengths.value(queue) - count);
+}
+
+QJsonObject QExecutionStatistics::toJson()
+{
+    QJsonObject statisticsJsonObject;
+
+    QJsonObject countersJsonObject;
+    QMapIterator<QString, qint64> counter(counters);
+    while (counter.hasNext()) {
+        counter.next();
+        countersJsonObject.insert(counter.key(), (double) counter.value());
+    }
+    statisticsJsonObject.insert("counters", countersJsonObject);
+
+    // Hit ratio in percents for every pair of hits and misses counters:
+    QJsonObject hitRatiosJsonObject;
+    foreach (QString counterName, counters.keys()) {
+        if (!counterName.endsWith("-hits")) {
+            continue;
+        }
+
+        QString cacheName = counterName;
+        cacheName.chop(QString("-hits").length());
+
+        qint64 hits = counters.value(counterName);
+        qint64 misses = counters.value(cacheName + "-misses");
+
+        if (hits + misses > 0) {
+            hitRatiosJsonObject.insert(cacheName,
+                                       (double) (hits * 100) / (hits + misses));
+        }
+    }
+    statisticsJsonObject.insert("hit-ratios", hitRatiosJsonObject);
+
+    // Most scripts are started at once and never wait in a queue,
+    // so the number of concurrently running scripts is reported:
+    QJsonObject concurrencyJsonObject;
+    concurrencyJsonObject.insert("scripts-running", (double) scriptsRunning);
+    concurrencyJsonObject.insert("scripts-running-peak",
+                                 (double) scriptsRunningPeak);
+    statisticsJsonObject.insert("concurrency", concurrencyJsonObject);
+
+    // Profiled scripts waiting for the profiler check and
+    // prefetch targets waiting for their turn are real queues:
+    QJsonObject queuesJsonObject;
+    foreach (QString queue, queueLengthsPeak.keys()) {
+        QJsonObject queueJsonObject;
+        queueJsonObject.insert("length", (double) queueLengths.value(queue));
+        queueJsonObject.insert("length-peak",
+                               (double) queueLengthsPeak.value(queue));
+        queuesJsonObject.insert(queue, queueJsonObject);
+    }
+    statisticsJsonObject.insert("queues", queuesJsonObject);
+
+    QJsonObject exitCodesJsonObject;
+    QMapIterator<QString, qint64> exitCode(exitCodes);
+    while (exitCode.hasNext()) {
+        exitCode.next();
+        exitCodesJsonObject.insert(exitCode.key(), (double) exitCode.value());
+    }
+    statisticsJsonObject.insert("exit-codes", exitCodesJsonObject);
+
+    QJsonObject histogramsJsonObject;
+    QMapIterator<QString, QLatencyHistogram> histogram(histograms);
+    while (histogram.hasNext()) {
+        histogram.next();
+
+        QJsonObject bucketsJsonObject;
+        for (int bucket = 0; bucket <= latencyBucketBoundsCount; bucket++) {
+            QString bucketName;
+            if (bucket < latencyBucketBoundsCount) {
+                bucketName = QString::number(latencyBucketBounds[bucket]);
+            } else {
+                bucketName = "+Inf";
+            }
+            bucketsJsonObject.insert(
+                        bucketName,
+                        (double) histogram.value().buckets.at(bucket));
+        }
+
+        QJsonObject histogramJsonObject;
+        histogramJsonObject.insert("count",
+                                   (double) histogram.value().count);
+        histogramJsonObject.insert("sum-msecs",
+                                   (double) histogram.value().sum);
+        histogramJsonObject.insert("max-msecs",
+                                   (double) histogram.value().maximum);
+        histogramJsonObject.insert("buckets-msecs", bucketsJsonObject);
+
+        histogramsJsonObject.insert(histogram.key(), histogramJsonObject);
+    }
+    statisticsJsonObject.insert("histograms", histogramsJsonObject);
+
+    // Open interactive scripts are counted in every browser window:
+    QJsonArray windowsJsonArray;
+    foreach (QWidget *widget, QApplication::allWidgets()) {
+        QWebViewWidget *window = qobject_cast<QWebViewWidget *>(widget);
+        if (window and !QWebViewWidget::qIsSpareWindow(window)) {
+            QPage *page = qobject_cast<QPage *>(window->page());
+            if (page) {
+                QJsonObject windowJsonObject;
+                windowJsonObject.insert("title", window->title());
+                windowJsonObject.insert(
+                            "interactive-scripts",
+                            page->interactiveScriptIsOpen() ? 1 : 0);
+                windowsJsonArray.append(windowJsonObject);
+            }
+        }
+    }
+    statisticsJsonObject.insert("windows", windowsJsonArray);
+
+    return statisticsJsonObject;
+}
+
+QString QExecutionStatistics::toHtml()
+{
+    QJsonObject statisticsJsonObject = toJson();
+    QString html;
+
+    // All names are escaped - counter names can be composed from
+    // any string passed to increment():
+    html.append("<table><tr><th>Counter</th><th>Value</th></tr>");
+    QJsonObject countersJsonObject =
+            statisticsJsonObject["counters"].toObject();
+    foreach (QString counter, countersJsonObject.keys()) {
+        html.append("<tr><td>" + counter.toHtmlEscaped() + "</td><td>" +
+                    QString::number(
+                        (qint64) countersJsonObject[counter].toDouble()) +
+                    "</td></tr>");
+    }
+    html.append("</table>");
+
+    html.append("<table><tr><th>Concurrency</th><th>Scripts</th></tr>");
+    QJsonObject concurrencyJsonObject =
+            statisticsJsonObject["concurrency"].toObject();
+    foreach (QString gauge, concurrencyJsonObject.keys()) {
+        html.append("<tr><td>" + gauge.toHtmlEscaped() + "</td><td>" +
+                    QString::number(
+                        (qint64) concurrencyJsonObject[gauge].toDouble()) +
+                    "</td></tr>");
+    }
+    html.append("</table>");
+
+    html.append("<table><tr><th>Queue</th><th>Length</th>"
+                "<th>Peak length</th></tr>");
+    QJsonObject queuesJsonObject =
+            statisticsJsonObject["queues"].toObject();
+    foreach (QString queue, queuesJsonObject.keys()) {
+        QJsonObject queueJsonObject = queuesJsonObject[queue].toObject();
+        html.append("<tr><td>" + queue.toHtmlEscaped() + "</td><td>" +
+                    QString::number(
+                        (qint64) queueJsonObject["length"].toDouble()) +
+                    "</td><td>" +
+                    QString::number(
+                        (qint64) queueJsonObject["length-peak"].toDouble()) +
+                    "</td></tr>");
+    }
+    html.append("</table>");
+
+    html.append("<table><tr><th>Cache</th><th>Hit ratio</th></tr>");
+    QJsonObject hitRatiosJsonObject =
+            statisticsJsonObject["hit-ratios"].toObject();
+    foreach (QString cacheName, hitRatiosJsonObject.keys()) {
+        html.append("<tr><td>" + cacheName.toHtmlEscaped() + "</td><td>" +
+                    QString::number(
+                        hitRatiosJsonObject[cacheName].toDouble(), 'f', 1) +
+                    " %</td></tr>");
+    }
+    html.append("</table>");
+
+    html.append("<table><tr><th>Exit code</th><th>Scripts</th></tr>");
+    QJsonObject exitCodesJsonObject =
+            statisticsJsonObject["exit-codes"].toObject();
+    foreach (QString exitCode, exitCodesJsonObject.keys()) {
+        html.append("<tr><td>" + exitCode.toHtmlEscaped() + "</td><td>" +
+                    QString::number(
+                        (qint64) exitCodesJsonObject[exitCode].toDouble()) +
+                    "</td></tr>");
+    }
+    html.append("</table>");
+
+    QMapIterator<QString, QLatencyHistogram> histogram(histograms);
+    while (histogram.hasNext()) {
+        histogram.next();
+
+        qint64 average = 0;
+        if (histogram.value().count > 0) {
+            average = histogram.value().sum / histogram.value().count;
+        }
+
+        html.append("<table><tr><th colspan='2'>" +
+                    histogram.key().toHtmlEscaped() +
+                    ": " + QString::number(histogram.value().count) +
+                    " samples, average " + QString::number(average) +
+                    " msecs, maximum " +
+                    QString::number(histogram.value().maximum) +
+                    " msecs</th></tr>");
+
+        for (int bucket = 0; bucket <= latencyBucketBoundsCount; bucket++) {
+            QString bucketName;
+            if (bucket < latencyBucketBoundsCount) {
+                bucketName = "&le; " +
+                        QString::number(latencyBucketBounds[bucket]) +
+                        " msecs";
+            } else {
+                bucketName = "&gt; " +
+                        QString::number(
+                            latencyBucketBounds[latencyBucketBoundsCount - 1])
+                        + " msecs";
+            }
+            html.append("<tr><td>" + bucketName + "</td><td>" +
+                        QString::number(
+                            histogram.value().buckets.at(bucket)) +
+                        "</td></tr>");
+        }
+        html.append("</table>");
+    }
+
+    html.append("<table><tr><th>Window</th>"
+                "<th>Open interactive scripts</th></tr>");
+    foreach (QJsonValue windowJsonValue,
+             statisticsJsonObject["windows"].toArray()) {
+        QJsonObject windowJsonObject = windowJsonValue.toObject();
+        html.append("<tr><td>" +
+                    windowJsonObject["title"].toString().toHtmlEscaped() +
+                    "</td><td>" +
+                    QString::number(
+                        (int) windowJsonObject["interactive-scripts"]
+                        .toDouble()) +
+                    "</td></tr>");
+    }
+    html.append("</table>");
+
+    return html;
+}
+
+// ==============================
+// LIVE OBJECTS:
+// ==============================
+QMutex QLiveObjects::mutex;
+QMap<QString, qint64> QLiveObjects::liveObjects;
+QMap<QString, qint64> QLiveObjects::createdObjects;
+
+void QLiveObjects::created(QString className)
+{
+#ifndef QT_NO_DEBUG
+    QMutexLocker locker(&mutex);
+    liveObjects[className]++;
+    createdObjects[className]++;
+#else
+    Q_UNUSED(className);
+#endif
+}
+
+void QLiveObjects::destroyed(QString className)
+{
+#ifndef QT_NO_DEBUG
+    QMutexLocker locker(&mutex);
+    liveObjects[className]--;
+#else
+    Q_UNUSED(className);
+#endif
+}
+
+// A prepared object starts to be used under another class name -
+// for example a spare window becoming a browser window:
+void QLiveObjects::moved(QString fromClassName, QString toClassName)
+{
+#ifndef QT_NO_DEBUG
+    QMutexLocker locker(&mutex);
+    liveObjects[fromClassName]--;
+    liveObjects[toClassName]++;
+    createdObjects[toClassName]++;
+#else
+    Q_UNUSED(fromClassName);
+    Q_UNUSED(toClassName);
+#endif
+}
+
+QJsonObject QLiveObjects::toJson()
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonObject liveObjectsJsonObject;
+    foreach (QString className, createdObjects.keys()) {
+        QJsonObject classJsonObject;
+        classJsonObject["live"] = liveObjects.value(className);
+        classJsonObject["created"] = createdObjects.value(className);
+        liveObjectsJsonObject[className] = classJsonObject;
+    }
+
+    return liveObjectsJsonObject;
+}
+
+// ==============================
+// TRUSTED DOMAINS:
+// ==============================
+QSet<QString> QTrustedDomains::exactDomains;
+QVector<QTrustedDomainNode> QTrustedDomains::wildcardTrie;
+
+QTrustedDomainNode::QTrustedDomainNode()
+{
+    wildcard = false;
+}
+
+void QTrustedDomains::setDomains(QStringList domains)
+{
+    exactDomains.clear();
+    wildcardTrie.clear();
+
+    // The root of the trie:
+    wildcardTrie.append(QTrustedDomainNode());
+
+    foreach (QString domain, domains) {
+        domain = domain.trimmed().toLower();
+
+        // Domains match any port, IPv6 addresses have no port here:
+        if (domain.count(":") == 1) {
+            qDebug() << "Port of trusted domain is ignored:" << domain;
+            domain = domain.left(domain.indexOf(":"));
+        }
+
+        if (!domain.startsWith("*.")) {
+            exactDomains.insert(domain);
+            continue;
+        }
+
+        QStringList labels = domain.mid(2).split(".");
+
+        int node = 0;
+        for (int index = labels.length() - 1; index >= 0; index--) {
+            int child = qChild(node, QStringRef(&labels.at(index)));
+
+            if (child < 0) {
+                child = wildcardTrie.size();
+                wildcardTrie[node].children.append(
+                            QPair<QString, int>(labels.at(index), child));
+                wildcardTrie.append(QTrustedDomainNode());
+            }
+
+            node = child;
+        }
+
+        wildcardTrie[node].wildcard = true;
+    }
+}
+
+// Nodes have only a few children and
+// labels are compared without copying them from the host:
+int QTrustedDomains::qChild(int node, const QStringRef &label)
+{
+    const QVector<QPair<QString, int> > &children =
+            wildcardTrie.at(node).children;
+
+    for (int index = 0; index < children.size(); index++) {
+        if (children.at(index).first == label) {
+            return children.at(index).second;
+        }
+    }
+
+    return -1;
+}
+
+bool QTrustedDomains::contains(const QString &host)
+{
+    if (exactDomains.contains(host)) {
+        return true;
+    }
+
+    if (wildcardTrie.size() <= 1) {
+        return false;
+    }
+
+    // Labels are walked from the top-level domain downwards and
+    // a wildcard node matches only if at least one more label follows:
+    int node = 0;
+    int end = host.length();
+    while (end > 0) {
+        int start = host.lastIndexOf(".", end - 1);
+
+        node = qChild(node, host.midRef(start + 1, end - start - 1));
+
+        if (node < 0 or start < 0) {
+            return false;
+        }
+
+        if (wildcardTrie.at(node).wildcard == true) {
+            return true;
+        }
+
+        end = start;
+    }
+
+    return false;
+}
+
+// ==============================
+// PAGE CACHE BUDGET:
+// ==============================
+QList<qint64> QPageCacheBudget::pageSizes;
+int QPageCacheBudget::currentCapacity = PAGE_CACHE_PAGES;
+
+int QPageCacheBudget::capacity()
+{
+    return currentCapacity;
+}
+
+void QPageCacheBudget::recordPage(qint64 bytes)
+{
+    pageSizes.append(bytes);
+    while (pageSizes.length() > PAGE_CACHE_PAGES) {
+        pageSizes.removeFirst();
+    }
+
+    // The most recent pages are kept as long as they fit in the budget:
+    qint64 budget = (qint64) PAGE_CACHE_MEMORY * 1024 * 1024;
+    qint64 total = 0;
+    int pages = 0;
+
+    for (int index = pageSizes.length() - 1; index >= 0; index--) {
+        total = total + pageSizes.at(index);
+        if (total > budget) {
+            break;
+        }
+        pages++;
+    }
+
+    if (pages != currentCapacity) {
+        currentCapacity = pages;
+        QWebSettings::setMaximumPagesInCache(currentCapacity);
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "page cache capacity set to" << currentCapacity
+                 << "pages.";
+    }
+}
+
+// ==============================
+// APPLICATION ARCHIVE:
+// ==============================
+QArchiveExtractor::QArchiveExtractor(QString root, QString target)
+    : QThread(0)
+{
+    rootDirectory = root;
+    targetDirectory = target;
+}
+
+void QArchiveExtractor::run()
+{
+    QDirIterator iterator(rootDirectory, QDir::Files,
+                          QDirIterator::Subdirectories);
+
+    int extractedFiles = 0;
+    while (iterator.hasNext()) {
+        QString archivedFilePath = iterator.next();
+        QString extractedFilePath =
+                targetDirectory + archivedFilePath.mid(rootDirectory.length());
+
+        QDir().mkpath(QFileInfo(extractedFilePath).absolutePath());
+        if (QFile::copy(archivedFilePath, extractedFilePath)) {
+            // Files copied from resources are read-only:
+            QFile::setPermissions(extractedFilePath,
+                                  QFile::ReadOwner | QFile::WriteOwner |
+                                  QFile::ExeOwner);
+            extractedFiles++;
+        }
+    }
+
+    qDebug() << QDateTime::currentMSecsSinceEpoch()
+             << "msecs from epoch:"
+             << "application archive extracted:" << extractedFiles
+             << "files in" << targetDirectory;
+}
+
+bool QApplicationArchive::packed = false;
+QString QApplicationArchive::archive;
+QTemporaryDir *QApplicationArchive::extractionDirectory = 0;
+QArchiveExtractor *QApplicationArchive::extractor = 0;
+
+bool QApplicationArchive::qRegister(QString archivePath)
+{
+    packed = QResource::registerResource(archivePath, "/app");
+
+    if (packed == true) {
+        archive = archivePath;
+    }
+
+    return packed;
+}
+
+// The archive is extracted while the start page is loading,
+// so that the GUI thread is not blocked by the first script:
+void QApplicationArchive::qStartExtraction()
+{
+    if (packed == false or extractor != 0) {
+        return;
+    }
+
+    extractionDirectory =
+            new QTemporaryDir(QDir::tempPath() + "/peb-app-XXXXXX");
+
+    extractor = new QArchiveExtractor(qRoot(), extractionDirectory->path());
+    extractor->start(QThread::LowPriority);
+}
+
+QString QApplicationArchive::qRoot()
+{
+    return ":/app";
+}
+
+// Resource paths always use '/', native separators are used
+// only for files of an application directory:
+QString QApplicationArchive::qFilePath(QString relativePath)
+{
+    QString filePath =
+            qApp->property("application").toString() + relativePath;
+
+    if (packed == true) {
+        return filePath;
+    }
+
+    return QDir::toNativeSeparators(filePath);
+}
+
+// Returns the directory from where local Perl scripts are started -
+// the application directory or the extracted application archive.
+// Scripts must not be started before qWhenExtracted() returns true:
+QString QApplicationArchive::qScriptsDirectory()
+{
+    if (packed == false or extractionDirectory == 0) {
+        return qApp->property("application").toString();
+    }
+
+    return QDir::toNativeSeparators(extractionDirectory->path());
+}
+
+// Returns true if scripts can be started at once.
+// Otherwise the slot of the receiver is called once the extraction is
+// finished and must tolerate a second call, if the extraction is
+// finished while this check is running. The GUI thread never waits:
+bool QApplicationArchive::qWhenExtracted(QObject *receiver, const char *slot)
+{
+    if (packed == false) {
+        return true;
+    }
+
+    if (extractor == 0) {
+        qStartExtraction();
+    }
+
+    QObject::connect(extractor, SIGNAL(finished()), receiver, slot,
+                     Qt::UniqueConnection);
+
+    if (extractor->isFinished()) {
+        QObject::disconnect(extractor, SIGNAL(finished()), receiver, slot);
+        return true;
+    }
+
+    qDebug() << QDateTime::currentMSecsSinceEpoch()
+             << "msecs from epoch:"
+             << "script waits for the application archive extraction.";
+    QExecutionStatistics::increment("archive-extraction-waits");
+
+    return false;
+}
+
+void QApplicationArchive::qCleanup()
+{
+    if (extractor != 0) {
+        extractor->wait();
+        delete extractor;
+        extractor = 0;
+    }
+
+    delete extractionDirectory;
+    extractionDirectory = 0;
+
+    if (packed == true) {
+        QResource::unregisterResource(archive, "/app");
+        packed = false;
+    }
+}
+
+// ==============================
+// STARTUP TIMER:
+// ==============================
+QStartupTimer::QStartupTimer()
+    : QObject(0)
+{
+    lastPhaseEnd = 0;
+    elapsedTimer.start();
+}
+
+void QStartupTimer::finishPhase(QString phase)
+{
+    qint64 phaseEnd = elapsedTimer.elapsed();
+
+    phases.append(phase);
+    phaseDurations.append(phaseEnd - lastPhaseEnd);
+
+    lastPhaseEnd = phaseEnd;
+}
+
+void QStartupTimer::report()
+{
+    qDebug() << "Startup timing report:";
+
+    for (int index = 0; index < phases.length(); index++) {
+        qDebug() << "Startup phase" << phases.at(index).toLatin1().constData()
+                 << "-" << phaseDurations.at(index) << "msecs";
+
+        QExecutionStatistics::increment(
+                    "startup-" + phases.at(index) + "-msecs",
+                    phaseDurations.at(index));
+    }
+
+    qDebug() << "Startup total -" << lastPhaseEnd
+             << "msecs from main() to loaded start page";
+
+    QExecutionStatistics::increment("startup-total-msecs", lastPhaseEnd);
+}
+
+// ==============================
+// SINGLE INSTANCE SERVER:
+// ==============================
+#if SINGLE_INSTANCE == 1
+QInstanceServer::QInstanceServer()
+    : QObject(0)
+{
+    // Every binary of every user has its own server:
+    QString userName = qgetenv("USER");
+    if (userName.length() == 0) {
+        userName = qgetenv("USERNAME");
+    }
+
+    serverName = "peb-" + QString(QCryptographicHash::hash(
+                                      (qApp->applicationFilePath() + userName)
+                                      .toUtf8(),
+                                      QCryptographicHash::Sha1).toHex());
+
+    forwardError = QLocalSocket::UnknownSocketError;
+
+    QObject::connect(&instanceServer, SIGNAL(newConnection()),
+                     this, SLOT(qNewConnectionSlot()));
+}
+
+// Returns true if the request is accepted by a running instance:
+bool QInstanceServer::qForwardRequest(QString request)
+{
+    QLocalSocket requestSocket;
+    requestSocket.connectToServer(serverName);
+
+    if (!requestSocket.waitForConnected(500)) {
+        forwardError = requestSocket.error();
+        return false;
+    }
+
+    requestSocket.write(request.toUtf8() + "\n");
+    requestSocket.waitForBytesWritten(500);
+    requestSocket.disconnectFromServer();
+
+    return true;
+}
+
+void QInstanceServer::qListen()
+{
+    // A server left over from a crashed instance is removed first.
+    // A running instance which did not answer in time is not removed:
+    if (forwardError == QLocalSocket::ConnectionRefusedError or
+            forwardError == QLocalSocket::ServerNotFoundError) {
+        QLocalServer::removeServer(serverName);
+    }
+
+    // Only the same user can connect to the server:
+    instanceServer.setSocketOptions(QLocalServer::UserAccessOption);
+
+    if (instanceServer.listen(serverName)) {
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "single instance server started:" << serverName;
+    } else {
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "single instance server not started:"
+                 << instanceServer.errorString();
+    }
+}
+#endif
+
+// ==============================
+// PERL INTERPRETER LOCATOR:
+// ==============================
+QPerlInterpreterLocator::QPerlInterpreterLocator(QString privateInterpreter)
+    : QObject(0)
+{
+    searching = false;
+
+    // A Perl interpreter bundled with the application is always preferred:
+    if (QFile(privateInterpreter).exists()) {
+        interpreter = privateInterpreter;
+        qApp->setProperty("perlInterpreter", interpreter);
+        return;
+    }
+
+    stateFilePath = QDir::toNativeSeparators(
+                QStandardPaths::writableLocation(
+                    QStandardPaths::CacheLocation)
+                + QDir::separator() + "perl-interpreter.json");
+
+    // The cached path is used only if PATH is not changed and
+    // the interpreter is not modified since it was found:
+    if (QFile(stateFilePath).exists()) {
+        QFileReader stateReader(stateFilePath);
+        QJsonObject state =
+                QJsonDocument::fromJson(stateReader.fileContents.toUtf8())
+                .object();
+
+        QString cachedInterpreter = state["interpreter"].toString();
+        QFileInfo cachedInterpreterInfo(cachedInterpreter);
+
+        if (cachedInterpreter.length() > 0 and
+                state["path"].toString() ==
+                QString::fromLocal8Bit(qgetenv("PATH")) and
+                cachedInterpreterInfo.exists() and
+                (qint64) state["last-modified"].toDouble() ==
+                cachedInterpreterInfo.lastModified().toMSecsSinceEpoch()) {
+            interpreter = cachedInterpreter;
+            qApp->setProperty("perlInterpreter", interpreter);
+
+            qDebug() << QDateTime::currentMSecsSinceEpoch()
+                     << "msecs from epoch:"
+                     << "cached Perl interpreter is used:" << interpreter;
+            return;
+        }
+    }
+
+    // Find the full path to the Perl interpreter on PATH:
+    QObject::connect(&locatorProcess,
+                     SIGNAL(finished(int, QProcess::ExitStatus)),
+                     this,
+                     SLOT(qLocatorFinishedSlot()));
+#if QT_VERSION >= 0x050600
+    QObject::connect(&locatorProcess,
+                     SIGNAL(errorOccurred(QProcess::ProcessError)),
+                     this,
+                     SLOT(qLocatorErrorSlot(QProcess::ProcessError)));
+#else
+    QObject::connect(&locatorProcess,
+                     SIGNAL(error(QProcess::ProcessError)),
+                     this,
+                     SLOT(qLocatorErrorSlot(QProcess::ProcessError)));
+#endif
+
+    searching = true;
+    locatorProcess.start("perl",
+                         QStringList()
+                         << "-e"
+                         << "print $^X;");
+}
+
+// The interpreter is not known until
+// the background search is over:
+bool QPerlInterpreterLocator::isSearching()
+{
+    return searching;
+}
+
+void QPerlInterpreterLocator::qSaveState()
+{
+    QJsonObject state;
+    state["path"] = QString::fromLocal8Bit(qgetenv("PATH"));
+    state["interpreter"] = interpreter;
+    state["last-modified"] =
+            (double) QFileInfo(interpreter).lastModified().toMSecsSinceEpoch();
+
+    QDir().mkpath(QFileInfo(stateFilePath).absolutePath());
+
+    QFile stateFile(stateFilePath);
+    if (stateFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        stateFile.write(QJsonDocument(state).toJson());
+        stateFile.close();
+    }
+}
+
+// ==============================
+// HIGHLIGHTED SOURCE CACHE:
+// ==============================
+#if PERL_DEBUGGER_INTERACTION == 1
+QHash<QString, QHighlightedSource> QHighlightedSourceCache::entries;
+
+bool QHighlightedSourceCache::find(QString filePath, QString &html)
+{
+    if (entries.contains(filePath) and
+            entries.value(filePath).lastModified ==
+            QFileInfo(filePath).lastModified()) {
+        html = entries.value(filePath).html;
+        QExecutionStatistics::increment("highlighted-source-cache-hits");
+        return true;
+    }
+
+    QExecutionStatistics::increment("highlighted-source-cache-misses");
+    return false;
+}
+
+void QHighlightedSourceCache::insert(QString filePath,
+                                     QDateTime lastModified,
+                                     QString html)
+{
+    QHighlightedSource highlightedSource;
+    highlightedSource.lastModified = lastModified;
+    highlightedSource.html = html;
+    entries.insert(filePath, highlightedSource);
+}
+
+// ==============================
+// PERL DEBUGGER PROMPT SCANNER:
+// ==============================
+QDebuggerPromptScanner::QDebuggerPromptScanner()
+{
+    reset();
+}
+
+void QDebuggerPromptScanner::reset()
+{
+    state = Text;
+    openingBrackets = 0;
+    closingBrackets = 0;
+    promptDigits = 0;
+}
+
+// Returns the positions in the output chunk right after
+// every command prompt that ends in it:
+QList<int> QDebuggerPromptScanner::scan(QString output)
+{
+    QList<int> promptEnds;
+
+    for (int index = 0; index < output.length(); index++) {
+        QChar character = output.at(index);
+
+        // The space after a prompt belongs to the prompt:
+        if (state == PromptEnd) {
+            state = Text;
+            if (character == ' ' and
+                    promptEnds.length() > 0 and
+                    promptEnds.last() == index) {
+                promptEnds.last() = index + 1;
+                continue;
+            }
+        }
+
+        if (character == 'D') {
+            state = PromptD;
+            continue;
+        }
+
+        if (state == PromptD) {
+            state = (character == 'B') ? PromptDB : Text;
+        } else if (state == PromptDB) {
+            if (character == '<') {
+                state = OpeningBrackets;
+                openingBrackets = 1;
+            } else {
+                state = Text;
+            }
+        } else if (state == OpeningBrackets) {
+            if (character == '<') {
+                openingBrackets++;
+            } else if (character.isDigit()) {
+                state = PromptDigits;
+                promptDigits = 1;
+            } else {
+                state = Text;
+            }
+        } else if (state == PromptDigits or state == ClosingBrackets) {
+            if (state == PromptDigits and
+                    character.isDigit() and
+                    promptDigits < 5) {
+                promptDigits++;
+            } else if (character == '>') {
+                closingBrackets =
+                        (state == PromptDigits) ? 1 : closingBrackets + 1;
+                state = ClosingBrackets;
+
+                // Nested prompts have matching brackets - 'DB<<2>>':
+                if (closingBrackets == openingBrackets) {
+                    promptEnds.append(index + 1);
+                    state = PromptEnd;
+                }
+            } else {
+                state = Text;
+            }
+        }
+    }
+
+    return promptEnds;
+}
+#endif
+
+// ==============================
+// MAIN WINDOW CLASS CONSTRUCTOR:
+// ==============================
+QMainBrowserWindow::QMainBrowserWindow(QWidget *parent)
+    : QMainWindow(parent)
+{
+    // !!! No need to implement code here, but must be declared !!!
+}
+
+// ==============================
+// CUSTOM NETWORK REPLY CONSTRUCTOR:
+// ==============================
+struct QCustomNetworkReplyPrivate
+{
+    QByteArray data;
+    int offset;
+    int readId;
+    bool streaming;
+    QPointer<QAsyncFileReader> reader;
+};
+
+QCustomNetworkReply::QCustomNetworkReply(
+        const QUrl &url, const QString &data, const QString &mime)
+    : QNetworkReply()
+{
+    QLiveObjects::created("QCustomNetworkReply");
+
+    qSetContents(url, data.toUtf8(), mime);
+}
+
+// Binary contents like images and fonts are served unchanged:
+QCustomNetworkReply::QCustomNetworkReply(
+        const QUrl &url, const QByteArray &data, const QString &mime)
+    : QNetworkReply()
+{
+    QLiveObjects::created("QCustomNetworkReply");
+
+    qSetContents(url, data, mime);
+}
+
+void QCustomNetworkReply::qSetContents(const QUrl &url,
+                                       const QByteArray &data,
+                                       const QString &mime)
+{
+    setFinished(true);
+    open(ReadOnly | Unbuffered);
+
+    reply = new QCustomNetworkReplyPrivate;
+    reply->offset = 0;
+    reply->readId = 0;
+    reply->streaming = false;
+
+    setUrl(url);
+
+    reply->data = data;
+
+    if (data.length() > 0) {
+        setHeader(QNetworkRequest::ContentLengthHeader,
+                  QVariant(reply->data.size()));
+        setHeader(QNetworkRequest::LastModifiedHeader,
+                  QVariant(QDateTime::currentDateTimeUtc()));
+        setHeader(QNetworkRequest::ContentTypeHeader, mime);
+    }
+
+    // Only local files with cache headers may be cached:
+    setRawHeader("Cache-Control", "no-store");
+
+    QTimer::singleShot(0, this, SIGNAL(metaDataChanged()));
+
+    if (data.length() > 0) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+        setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, "OK");
+    } else {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 204);
+    }
+
+    QTimer::singleShot(0, this, SIGNAL(readyRead()));
+    QTimer::singleShot(0, this, SIGNAL(finished()));
+}
+
+// Streaming reply for large local files -
+// it is finished only after the whole file is read:
+QCustomNetworkReply::QCustomNetworkReply(
+        const QUrl &url, const QString &filePath, const QString &mime,
+        const QIndexedFile &file)
+    : QNetworkReply()
+{
+    QLiveObjects::created("QCustomNetworkReply");
+
+    open(ReadOnly | Unbuffered);
+
+    reply = new QCustomNetworkReplyPrivate;
+    reply->offset = 0;
+    reply->streaming = true;
+
+    setUrl(url);
+
+    setHeader(QNetworkRequest::ContentLengthHeader, QVariant(file.size));
+    setHeader(QNetworkRequest::ContentTypeHeader, mime);
+    setRawHeader("Cache-Control", "no-store");
+
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, "OK");
+
+    QTimer::singleShot(0, this, SIGNAL(metaDataChanged()));
+
+    reply->reader = QAsyncFileReader::qSharedReader();
+    reply->readId = reply->reader->qStartRead(this, filePath);
+
+    QExecutionStatistics::increment("async-file-reads");
+}
+
+QCustomNetworkReply::~QCustomNetworkReply()
+{
+    if (reply->readId > 0 and !reply->reader.isNull()) {
+        reply->reader->qCancelRead(reply->readId);
+    }
+
+    delete reply;
+
+    QLiveObjects::destroyed("QCustomNetworkReply");
+}
+
+void QCustomNetworkReply::qAppendChunk(QByteArray chunk)
+{
+    // Data already read by WebKit is released:
+    if (reply->offset >= reply->data.size()) {
+        reply->data.clear();
+        reply->offset = 0;
+    }
+
+    reply->data.append(chunk);
+
+    emit readyRead();
+}
+
+void QCustomNetworkReply::qFinishRead(bool success)
+{
+    reply->readId = 0;
+
+    if (success == false) {
+        setError(QNetworkReply::ContentNotFoundError,
+                 "Local file could not be read.");
+        emit error(QNetworkReply::ContentNotFoundError);
+    }
+
+    setFinished(true);
+    emit finished();
+}
+
+void QCustomNetworkReply::qSetCacheHeaders(const QIndexedFile &file,
+                                           bool revalidate)
+{
+    setHeader(QNetworkRequest::LastModifiedHeader,
+              QVariant(file.lastModified.toUTC()));
+    setRawHeader("ETag", file.qEntityTag());
+
+    if (revalidate == true) {
+        setRawHeader("Cache-Control", "no-cache");
+    } else {
+        setRawHeader("Cache-Control", "max-age=31536000");
+    }
+}
+
+void QCustomNetworkReply::qSetNotModified(const QIndexedFile &file)
+{
+    qSetCacheHeaders(file, true);
+
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 304);
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, "Not Modified");
+}
+
+// Replaces the data of the reply with a single byte range of a local file -
+// 'Range: bytes=first-last', 'bytes=first-' or 'bytes=-suffix'.
+// No more than ASYNC_READ_THRESHOLD bytes are read on the GUI thread,
+// longer ranges like 'bytes=0-' of a big video are answered partially and
+// the client requests the rest starting after the last sent byte.
+// Returns false if the range is not a single byte range and
+// the whole file has to be sent:
+bool QCustomNetworkReply::qSetByteRange(QString filePath,
+                                        const QIndexedFile &file,
+                                        QString mime,
+                                        QByteArray range)
+{
+    QRegExp rangeMarker("^bytes=(\\d*)-(\\d*)$");
+    if (!rangeMarker.exactMatch(QString::fromLatin1(range).trimmed()) or
+            (rangeMarker.cap(1).length() == 0 and
+             rangeMarker.cap(2).length() == 0)) {
+        return false;
+    }
+
+    qint64 first;
+    qint64 last = file.size - 1;
+
+    if (rangeMarker.cap(1).length() == 0) {
+        first = qMax((qint64) 0, file.size - rangeMarker.cap(2).toLongLong());
+    } else {
+        first = rangeMarker.cap(1).toLongLong();
+        if (rangeMarker.cap(2).length() > 0) {
+            last = qMin(last, rangeMarker.cap(2).toLongLong());
+        }
+    }
+
+    setRawHeader("Accept-Ranges", "bytes");
+
+    if (first >= file.size or first > last) {
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 416);
+        setAttribute(QNetworkRequest::HttpReasonPhraseAttribute,
+                     "Requested Range Not Satisfiable");
+        setRawHeader("Content-Range",
+                     "bytes */" + QByteArray::number(file.size));
+        return true;
+    }
+
+    if (last - first + 1 > ASYNC_READ_THRESHOLD) {
+        last = first + ASYNC_READ_THRESHOLD - 1;
+        QExecutionStatistics::increment("byte-range-truncations");
+    }
+
+    // Only the requested range is read from the file:
+    QFile rangeFile(filePath);
+    if (!rangeFile.open(QIODevice::ReadOnly) or !rangeFile.seek(first)) {
+        return false;
+    }
+
+    reply->data = rangeFile.read(last - first + 1);
+    reply->offset = 0;
+    rangeFile.close();
+
+    setHeader(QNetworkRequest::ContentLengthHeader,
+              QVariant(reply->data.size()));
+    setHeader(QNetworkRequest::ContentTypeHeader, mime);
+    setRawHeader("Content-Range",
+                 "bytes " + QByteArray::number(first) + "-"
+                 + QByteArray::number(first + reply->data.size() - 1)
+                 + "/" + QByteArray::number(file.size));
+
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 206);
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute,
+                 "Partial Content");
+
+    QExecutionStatistics::increment("byte-range-requests");
+
+    return true;
+}
+
+qint64 QCustomNetworkReply::size() const
+{
+    return reply->data.size();
+}
+
+void QCustomNetworkReply::abort()
+{
+    // Only streaming replies have something to abort:
+    if (reply->readId > 0) {
+        if (!reply->reader.isNull()) {
+            reply->reader->qCancelRead(reply->readId);
+        }
+        reply->readId = 0;
+
+        setError(QNetworkReply::OperationCanceledError,
+                 "Local file read aborted.");
+        setFinished(true);
+        emit finished();
+    }
+}
+
+qint64 QCustomNetworkReply::bytesAvailable() const
+{
+    // For seekable replies QIODevice counts the same unread data again:
+    if (reply->streaming == false) {
+        return reply->data.size() - reply->offset;
+    }
+
+    return (reply->data.size() - reply->offset) +
+            QNetworkReply::bytesAvailable();
+}
+
+// Replies holding all of their data can be seeked,
+// streaming replies release the data already read:
+bool QCustomNetworkReply::isSequential() const
+{
+    return reply->streaming;
+}
+
+bool QCustomNetworkReply::seek(qint64 position)
+{
+    if (reply->streaming == true or
+            position < 0 or position > reply->data.size()) {
+        return false;
+    }
+
+    QNetworkReply::seek(position);
+    reply->offset = position;
+    return true;
+}
+
+qint64 QCustomNetworkReply::read(char *data, qint64 maxSize)
+{
+    return readData(data, maxSize);
+}
+
+qint64 QCustomNetworkReply::readData(char *data, qint64 maxSize)
+{
+    // Streaming replies may be waiting for their next chunk:
+    if (reply->offset >= reply->data.size()) {
+        return (isFinished() == true) ? -1 : 0;
+    }
+
+    qint64 number = qMin(maxSize, (qint64) reply->data.size() - reply->offset);
+    memcpy(data, reply->data.constData() + reply->offset, number);
+    reply->offset += number;
+
+    // A paused read is resumed when its reply is drained:
+    if (reply->streaming == true and reply->readId > 0 and
+            !reply->reader.isNull()) {
+        reply->reader->qConsumeChunk(reply->readId, number);
+    }
+
+    return number;
+}
+
+// ==============================
+// ASYNCHRONOUS FILE READER:
+// ==============================
+QAsyncFileReader *QAsyncFileReader::sharedReader = 0;
+
+QAsyncFileReader::QAsyncFileReader()
+    : QObject(0)
+{
+    lastReadId = 0;
+}
+
+QAsyncFileReader::~QAsyncFileReader()
+{
+    // Pending reads are cancelled and
+    // no reading thread may outlive the reader:
+    mutex.lock();
+    foreach (int readId, replies.keys()) {
+        cancelledReads.insert(readId);
+    }
+    mutex.unlock();
+
+    threadPool.waitForDone();
+
+    if (sharedReader == this) {
+        sharedReader = 0;
+    }
+}
+
+QAsyncFileReader *QAsyncFileReader::qSharedReader()
+{
+    if (sharedReader == 0) {
+        sharedReader = new QAsyncFileReader();
+        sharedReader->setParent(qApp);
+    }
+
+    return sharedReader;
+}
+
+int QAsyncFileReader::qStartRead(QCustomNetworkReply *reply,
+                                 QString filePath)
+{
+    lastReadId++;
+    replies.insert(lastReadId, reply);
+
+    threadPool.start(
+                new QAsyncFileReadTask(this, lastReadId, filePath, false));
+
+    return lastReadId;
+}
+
+// Small files are read at once and delivered by 'fileReadSignal':
+int QAsyncFileReader::qReadFile(QString filePath)
+{
+    lastReadId++;
+
+    threadPool.start(
+                new QAsyncFileReadTask(this, lastReadId, filePath, true));
+
+    return lastReadId;
+}
+
+void QAsyncFileReader::qCancelRead(int readId)
+{
+    replies.remove(readId);
+
+    QMutexLocker locker(&mutex);
+    bufferedBytes.remove(readId);
+
+    // A paused read has no running task, which could see the cancellation:
+    if (pausedReads.remove(readId) == 0) {
+        cancelledReads.insert(readId);
+    }
+}
+
+bool QAsyncFileReader::qIsCancelled(int readId)
+{
+    QMutexLocker locker(&mutex);
+    return cancelledReads.contains(readId);
+}
+
+// Chunks are counted on the reading thread before they are sent,
+// so that chunks waiting in the event queue are also counted:
+void QAsyncFileReader::qBufferChunk(int readId, qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    bufferedBytes[readId] += bytes;
+}
+
+// Reading stops while its reply holds ASYNC_READ_BUFFER_SIZE unread bytes.
+// The task ends and no thread of the pool waits for the reply -
+// the read is continued by a new task when the reply is drained:
+bool QAsyncFileReader::qPauseRead(int readId, QString filePath,
+                                  qint64 position)
+{
+    QMutexLocker locker(&mutex);
+
+    if (cancelledReads.contains(readId) or
+            bufferedBytes.value(readId) < ASYNC_READ_BUFFER_SIZE) {
+        return false;
+    }
+
+    pausedReads.insert(readId, qMakePair(filePath, position));
+    return true;
+}
+
+void QAsyncFileReader::qConsumeChunk(int readId, qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!bufferedBytes.contains(readId)) {
+        return;
+    }
+
+    bufferedBytes[readId] -= bytes;
+
+    if (pausedReads.contains(readId) and
+            bufferedBytes.value(readId) <= ASYNC_READ_BUFFER_SIZE / 2) {
+        QPair<QString, qint64> pausedRead = pausedReads.take(readId);
+        threadPool.start(
+                    new QAsyncFileReadTask(this, readId, pausedRead.first,
+                                           false, pausedRead.second));
+
+        QExecutionStatistics::increment("async-read-resumes");
+    }
+}
+
+QAsyncFileReadTask::QAsyncFileReadTask(QAsyncFileReader *reader,
+                                       int readId,
+                                       QString filePath,
+                                       bool wholeFile,
+                                       qint64 position)
+{
+    this->reader = reader;
+    this->readId = readId;
+    this->filePath = filePath;
+    this->wholeFile = wholeFile;
+    this->position = position;
+}
+
+// Runs on a thread of the pool - the reader is reached only
+// through queued calls and its thread-safe cancellation check:
+void QAsyncFileReadTask::run()
+{
+    QFile file(filePath);
+    bool success = file.open(QIODevice::ReadOnly);
+
+    if (wholeFile == true) {
+        QByteArray contents;
+        if (success == true) {
+            contents = file.readAll();
+        }
+        file.close();
+
+        QMetaObject::invokeMethod(reader, "qFileReadSlot",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, readId),
+                                  Q_ARG(QByteArray, contents),
+                                  Q_ARG(bool, success));
+        return;
+    }
+
+    // A resumed read continues where its previous task stopped:
+    if (success == true and position > 0) {
+        success = file.seek(position);
+    }
+
+    while (success == true and file.atEnd() == false) {
+        if (reader->qIsCancelled(readId)) {
+            break;
+        }
+
+        if (reader->qPauseRead(readId, filePath, file.pos())) {
+            file.close();
+            return;
+        }
+
+        QByteArray chunk = file.read(ASYNC_READ_CHUNK_SIZE);
+        if (chunk.isEmpty()) {
+            success = false;
+            break;
+        }
+
+        reader->qBufferChunk(readId, chunk.size());
+        QMetaObject::invokeMethod(reader, "qChunkReadSlot",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, readId),
+                                  Q_ARG(QByteArray, chunk));
+    }
+
+    file.close();
+
+    QMetaObject::invokeMethod(reader, "qReadFinishedSlot",
+                              Qt::QueuedConnection,
+                              Q_ARG(int, readId),
+                              Q_ARG(bool, success));
+}
+
+// ==============================
+// PREFETCH ENGINE:
+// ==============================
+QPrefetchEngine *QPrefetchEngine::sharedEngine = 0;
+
+QPrefetchEngine::QPrefetchEngine()
+    : QObject(0)
+{
+    runningTask.page = 0;
+    runningTask.script = false;
+    runningReadId = 0;
+    running = false;
+
+    QObject::connect(QAsyncFileReader::qSharedReader(),
+                     SIGNAL(fileReadSignal(int, QByteArray, bool)),
+                     this,
+                     SLOT(qFilePrefetchedSlot(int, QByteArray, bool)));
+}
+
+QPrefetchEngine *QPrefetchEngine::qSharedEngine()
+{
+    if (sharedEngine == 0) {
+        sharedEngine = new QPrefetchEngine();
+        sharedEngine->setParent(qApp);
+    }
+
+    return sharedEngine;
+}
+
+// Replaces everything prefetched for a page with
+// the targets linked from its newly loaded document:
+void QPrefetchEngine::qStart(QObject *page,
+                             QList<QUrl> urls,
+                             QSet<QString> markedUrls)
+{
+    qCancel(page);
+    qDiscard(page);
+
+    QObject::connect(page, SIGNAL(destroyed(QObject*)),
+                     this, SLOT(qPageDestroyedSlot(QObject*)),
+                     Qt::UniqueConnection);
+
+    budgets.insert(page, PREFETCH_BUDGET);
+    queuedUrls.insert(page, QSet<QString>());
+
+    foreach (QUrl url, urls) {
+        qQueue(page, url, markedUrls.contains(url.toString()));
+    }
+
+    if (running == false and tasks.length() > 0) {
+        running = true;
+        QTimer::singleShot(0, this, SLOT(qPrefetchNextSlot()));
+    }
+}
+
+// Perl scripts are prefetched only if they are AJAX scripts and
+// their elements are marked with the 'data-peb-prefetch' attribute:
+void QPrefetchEngine::qQueue(QObject *page, QUrl url, bool marked)
+{
+    if (budgets.value(page, 0) == 0 or
+            url.authority() != PSEUDO_DOMAIN or
+            queuedUrls.value(page).contains(url.toString())) {
+        return;
+    }
+
+    QIndexedFile file = QApplicationFileIndex::qFile(
+                QApplicationArchive::qFilePath(url.path()));
+
+    if (file.exists == false) {
+        return;
+    }
+
+    QPrefetchTask task;
+    task.page = page;
+    task.url = url;
+    task.script = false;
+    task.file = file;
+
+    if (file.mimeType == "application/x-perl") {
+        // Only idempotent GET scripts are run in advance:
+        if (marked == false or
+                !url.path().contains("ajax", Qt::CaseInsensitive)) {
+            return;
+        }
+        task.script = true;
+    } else {
+        // Large files are read asynchronously when requested and
+        // only files displayed by the browser are prefetched:
+        if (file.size > ASYNC_READ_THRESHOLD or
+                url.hasQuery() or
+                !(file.mimeType.startsWith("text/") or
+                  file.mimeType.startsWith("image/") or
+                  file.mimeType.contains("javascript") or
+                  file.mimeType.contains("json") or
+                  file.mimeType.contains("font"))) {
+            return;
+        }
+    }
+
+    queuedUrls[page].insert(url.toString());
+    tasks.append(task);
+    QExecutionStatistics::enqueued("prefetch-tasks");
+    budgets[page]--;
+}
+
+// Stylesheets, scripts and images of a prefetched page,
+// so that they are ready when the page itself is requested:
+QList<QUrl> QPrefetchEngine::qSubresources(QUrl pageUrl, QByteArray html)
+{
+    QList<QUrl> subresources;
+    QString contents = QString::fromUtf8(html);
+
+    QRegExp tagExpression("<(link|script|img)\\s[^>]*>",
+                          Qt::CaseInsensitive);
+    QRegExp attributeExpression(
+                "\\s(href|src|rel)\\s*=\\s*(?:'([^']*)'|\"([^\"]*)\")",
+                Qt::CaseInsensitive);
+
+    int position = 0;
+    while ((position = tagExpression.indexIn(contents, position)) >= 0) {
+        QString tag = tagExpression.cap(0);
+        QString tagName = tagExpression.cap(1).toLower();
+        position = position + tagExpression.matchedLength();
+
+        QHash<QString, QString> attributes;
+        int attributePosition = 0;
+        while ((attributePosition =
+                attributeExpression.indexIn(tag, attributePosition)) >= 0) {
+            attributes.insert(attributeExpression.cap(1).toLower(),
+                              attributeExpression.cap(2)
+                              + attributeExpression.cap(3));
+            attributePosition = attributePosition
+                    + attributeExpression.matchedLength();
+        }
+
+        QString target;
+        if (tagName == "link") {
+            if (attributes.value("rel").toLower() == "stylesheet") {
+                target = attributes.value("href");
+            }
+        } else {
+            target = attributes.value("src");
+        }
+
+        if (target.length() > 0) {
+            QUrl url = pageUrl.resolved(QUrl(target));
+            url.setFragment(QString());
+            subresources.append(url);
+        }
+    }
+
+    return subresources;
+}
+
+// Prefetching is cancelled when a page navigates away -
+// queued targets are dropped and a running read or script is ignored,
+// targets already prefetched stay available for the next document:
+void QPrefetchEngine::qCancel(QObject *page)
+{
+    QList<QPrefetchTask>::iterator task = tasks.begin();
+    while (task != tasks.end()) {
+        if (task->page == page) {
+            task = tasks.erase(task);
+            QExecutionStatistics::dequeued("prefetch-tasks");
+        } else {
+            ++task;
+        }
+    }
+
+    budgets.remove(page);
+    queuedUrls.remove(page);
+
+    if (runningTask.page == page) {
+        runningTask.page = 0;
+    }
+}
+
+void QPrefetchEngine::qDiscard(QObject *page)
+{
+    QExecutionStatistics::increment("prefetch-discarded",
+                                    resources.value(page).size());
+    resources.remove(page);
+}
+
+bool QPrefetchEngine::qTakeFile(QObject *page, QUrl url,
+                                const QIndexedFile &file,
+                                QByteArray &contents)
+{
+    if (!resources.value(page).contains(url.toString()) or
+            resources.value(page).value(url.toString()).script == true) {
+        QExecutionStatistics::increment("prefetch-misses");
+        return false;
     }
 
-    QTimer::singleShot(0, this, SIGNAL(metaDataChanged()));
+    QPrefetchedResource resource = resources[page].take(url.toString());
 
-    if (data.length() > 0) {
-        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
-        setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, "OK");
-        reply->data = data.toUtf8();
-    } else {
-        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 204);
+    // Files changed after they were prefetched are read again:
+    if (resource.lastModified != file.lastModified) {
+        QExecutionStatistics::increment("prefetch-misses");
+        return false;
     }
 
-    QTimer::singleShot(0, this, SIGNAL(readyRead()));
-    QTimer::singleShot(0, this, SIGNAL(finished()));
+    contents = resource.contents;
+    QExecutionStatistics::increment("prefetch-hits");
+    return true;
 }
 
-QCustomNetworkReply::~QCustomNetworkReply()
+bool QPrefetchEngine::qTakeScriptOutput(QObject *page, QUrl url,
+                                        QString &output)
 {
-    delete reply;
-}
+    if (!resources.value(page).contains(url.toString()) or
+            resources.value(page).value(url.toString()).script == false) {
+        QExecutionStatistics::increment("prefetch-misses");
+        return false;
+    }
 
-qint64 QCustomNetworkReply::size() const
-{
-    return reply->data.size();
+    output = QString::fromUtf8(resources[page].take(url.toString()).contents);
+    QExecutionStatistics::increment("prefetch-hits");
+    return true;
 }
 
-void QCustomNetworkReply::abort()
+// Targets are prefetched one at a time,
+// files are read as bytes on the thread pool of the file reader,
+// so that images and fonts are not changed and the GUI thread is free:
+void QPrefetchEngine::qPrefetchNextSlot()
 {
-    // !!! No need to implement code here, but must be declared !!!
+    if (tasks.length() == 0) {
+        running = false;
+        return;
+    }
+
+    runningTask = tasks.takeFirst();
+    QExecutionStatistics::dequeued("prefetch-tasks");
+
+    if (runningTask.script == true) {
+        QNonInteractiveScriptHandler *prefetchScriptHandler =
+                new QNonInteractiveScriptHandler(
+                    runningTask.url, QByteArray(), true);
+
+        QObject::connect(prefetchScriptHandler,
+                         SIGNAL(scriptFinishedSignal(QString,
+                                                     QString,
+                                                     QString,
+                                                     QString,
+                                                     bool)),
+                         this,
+                         SLOT(qScriptPrefetchedSlot(QString,
+                                                    QString,
+                                                    QString,
+                                                    QString)));
+        return;
+    }
+
+    QString fullFilePath =
+            QApplicationArchive::qFilePath(runningTask.url.path());
+
+    runningReadId = QAsyncFileReader::qSharedReader()->qReadFile(fullFilePath);
 }
 
-qint64 QCustomNetworkReply::bytesAvailable() const
+void QPrefetchEngine::qFilePrefetchedSlot(int readId,
+                                          QByteArray contents,
+                                          bool success)
 {
-    return size();
+    // Whole-file reads of other users of the file reader are ignored:
+    if (readId != runningReadId) {
+        return;
+    }
+
+    runningReadId = 0;
+
+    if (runningTask.page != 0 and success == true) {
+        QPrefetchedResource resource;
+        resource.contents = contents;
+        resource.lastModified = runningTask.file.lastModified;
+        resource.script = false;
+
+        resources[runningTask.page].insert(runningTask.url.toString(),
+                                           resource);
+        QExecutionStatistics::increment("prefetched-files");
+
+        if (runningTask.file.mimeType == "text/html") {
+            foreach (QUrl subresource,
+                     qSubresources(runningTask.url, contents)) {
+                qQueue(runningTask.page, subresource, false);
+            }
+        }
+    }
+
+    runningTask.page = 0;
+
+    QTimer::singleShot(0, this, SLOT(qPrefetchNextSlot()));
 }
 
-bool QCustomNetworkReply::isSequential() const
+void QPrefetchEngine::qScriptPrefetchedSlot(QString scriptAccumulatedOutput,
+                                            QString scriptAccumulatedErrors,
+                                            QString scriptFullFilePath,
+                                            QString scriptOutputTarget)
 {
-    return true;
+    Q_UNUSED(scriptFullFilePath);
+    Q_UNUSED(scriptOutputTarget);
+
+    sender()->deleteLater();
+
+    // Output of scripts with errors is never served from memory:
+    if (runningTask.page != 0 and
+            scriptAccumulatedErrors.trimmed().length() == 0) {
+        QPrefetchedResource resource;
+        resource.contents = scriptAccumulatedOutput.toUtf8();
+        resource.script = true;
+
+        resources[runningTask.page].insert(
+                    runningTask.url.toString(), resource);
+        QExecutionStatistics::increment("prefetched-scripts");
+    }
+
+    runningTask.page = 0;
+
+    QTimer::singleShot(0, this, SLOT(qPrefetchNextSlot()));
 }
 
-qint64 QCustomNetworkReply::read(char *data, qint64 maxSize)
+// ==============================
+// SCRIPT PROCESS CONSTRUCTOR:
+// ==============================
+QScriptProcess::QScriptProcess()
+    : QProcess(0)
 {
-    return readData(data, maxSize);
+    cpuTimeLimit = SCRIPT_CPU_TIME_LIMIT;
+    memoryLimit = SCRIPT_MEMORY_LIMIT;
 }
 
-qint64 QCustomNetworkReply::readData(char *data, qint64 maxSize)
+// Executed in the child process after fork() and before exec(),
+// so only async-signal-safe calls are allowed here:
+void QScriptProcess::setupChildProcess()
 {
-    if (reply->offset >= reply->data.size()) {
-        return -1;
+#ifndef Q_OS_WIN
+    // Every script is the leader of its own process group,
+    // so that a timed out script is terminated with all its children:
+    setpgid(0, 0);
+
+    struct rlimit limit;
+
+    if (cpuTimeLimit > 0) {
+        // SIGXCPU is sent at the soft limit and SIGKILL one second later:
+        limit.rlim_cur = (rlim_t) cpuTimeLimit;
+        limit.rlim_max = (rlim_t) cpuTimeLimit + 1;
+        setrlimit(RLIMIT_CPU, &limit);
     }
 
-    qint64 number = qMin(maxSize, (qint64) reply->data.size() - reply->offset);
-    memcpy(data, reply->data.constData() + reply->offset, number);
-    reply->offset += number;
-    return number;
+    if (memoryLimit > 0) {
+        limit.rlim_cur = (rlim_t) memoryLimit * 1024 * 1024;
+        limit.rlim_max = (rlim_t) memoryLimit * 1024 * 1024;
+        setrlimit(RLIMIT_AS, &limit);
+    }
+#endif
 }
 
 // ==============================
 // NONINTERACTIVE SCRIPT HANDLER CONSTRUCTOR:
 // ==============================
 QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
-        QUrl url, QByteArray postDataArray)
+        QUrl url, QByteArray postDataArray, bool prefetched)
     : QObject(0)
 {
+    QLiveObjects::created("QNonInteractiveScriptHandler");
+
     // Signals and slots for local long running Perl scripts:
     QObject::connect(&scriptHandler, SIGNAL(readyReadStandardOutput()),
                      this, SLOT(qNonInteractiveScriptOutputSlot()));
@@ -619,7 +2516,48 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
     QObject::connect(&scriptHandler,
                      SIGNAL(finished(int, QProcess::ExitStatus)),
                      this,
-                     SLOT(qNonInteractiveScriptFinishedSlot()));
+                     SLOT(qNonInteractiveScriptFinishedSlot(
+                              int, QProcess::ExitStatus)));
+
+    QObject::connect(&scriptHandler, SIGNAL(started()),
+                     this, SLOT(qNonInteractiveScriptStartedSlot()));
+
+    // Signals and slots for resource limits and resource usage:
+    QObject::connect(&scriptTimeoutTimer, SIGNAL(timeout()),
+                     this, SLOT(qScriptTimeoutSlot()));
+    QObject::connect(&resourceSamplingTimer, SIGNAL(timeout()),
+                     this, SLOT(qSampleResourceUsageSlot()));
+
+    scriptTimedOut = false;
+    scriptPeakResidentKilobytes = -1;
+    scriptCpuTimeMilliseconds = 0;
+
+    scriptPrefetched = prefetched;
+    scriptFirstOutputReceived = false;
+    scriptElapsedTimer.start();
+    QExecutionStatistics::increment(qStatistic("script-launches"));
+
+    scriptStarted = false;
+    scriptUrl = url;
+    scriptPostDataArray = postDataArray;
+
+    // Scripts of a packed application are started when
+    // the extraction of the archive is finished:
+    if (QApplicationArchive::qWhenExtracted(
+                this, SLOT(qStartScriptSlot()))) {
+        qStartScriptSlot();
+    }
+}
+
+void QNonInteractiveScriptHandler::qStartScriptSlot()
+{
+    if (scriptStarted == true) {
+        return;
+    }
+    scriptStarted = true;
+
+    QUrl url = scriptUrl;
+    QByteArray postDataArray = scriptPostDataArray;
 
     QUrlQuery scriptQuery(url);
 
@@ -627,6 +2565,18 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
     scriptQuery.removeQueryItem("target");
     // qDebug() << "Script output target:" << scriptOutputTarget;
 
+    // Script timeout can only lower the global timeout:
+    scriptTimeoutSeconds = SCRIPT_TIMEOUT;
+    int requestedTimeoutSeconds =
+            scriptQuery.queryItemValue("timeout").toInt();
+    scriptQuery.removeQueryItem("timeout");
+
+    if (requestedTimeoutSeconds > 0 and
+            (scriptTimeoutSeconds == 0 or
+             requestedTimeoutSeconds < scriptTimeoutSeconds)) {
+        scriptTimeoutSeconds = requestedTimeoutSeconds;
+    }
+
 #if ADMIN_PRIVILEGES_CHECK == 0
     scriptUser = scriptQuery.queryItemValue("user");
     scriptQuery.removeQueryItem("user");
@@ -634,14 +2584,44 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
 #endif
 
     scriptFullFilePath = QDir::toNativeSeparators
-            ((qApp->property("application").toString()) + url.path());
-
-    QString queryString = scriptQuery.toString();
-    QString postData(postDataArray);
+            (QApplicationArchive::qScriptsDirectory() + url.path());
 
     QProcessEnvironment scriptEnvironment =
             QProcessEnvironment::systemEnvironment();
 
+    QStringList interpreterArguments;
+
+#if PERL_PROFILER_INTERACTION == 1
+    // Profile the script using Devel::NYTProf:
+    if (scriptQuery.queryItemValue("profile") == "nytprof" and
+            QProfileReportHandler::qReportsDirectory().length() == 0) {
+        scriptAccumulatedErrors.append(
+                    "No private directory is available for profile reports, "
+                    "the script is not profiled.\n");
+    } else if (scriptQuery.queryItemValue("profile") == "nytprof") {
+        scriptProfileDirectory = QDir::toNativeSeparators(
+                    QProfileReportHandler::qReportsDirectory()
+                    + QDir::separator()
+                    + QFileInfo(scriptFullFilePath).baseName() + "-"
+                    + QDateTime::currentDateTime()
+                    .toString("yyyy-MM-dd--hh-mm-ss-zzz"));
+        QDir().mkpath(scriptProfileDirectory);
+
+        scriptEnvironment.insert("NYTPROF",
+                                 "file=" + scriptProfileDirectory
+                                 + QDir::separator() + "nytprof.out");
+        interpreterArguments << "-d:NYTProf";
+
+        qDebug() << "Script profile directory:" << scriptProfileDirectory;
+    }
+    scriptQuery.removeQueryItem("profile");
+#endif
+
+    interpreterArguments << "-M-ops=fork" << scriptFullFilePath;
+
+    QString queryString = scriptQuery.toString();
+    QString postData(postDataArray);
+
     if (queryString.length() > 0) {
         scriptEnvironment.insert("REQUEST_METHOD", "GET");
         scriptEnvironment.insert("QUERY_STRING", queryString);
@@ -659,9 +2639,7 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
 
     if (scriptUser != "root") {
         scriptHandler.start((qApp->property("perlInterpreter").toString()),
-                            QStringList()
-                            << "-M-ops=fork"
-                            << scriptFullFilePath,
+                            interpreterArguments,
                             QProcess::Unbuffered | QProcess::ReadWrite);
 
         if (postData.length() > 0) {
@@ -731,14 +2709,21 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
             echo.waitForFinished();
             echo.close();
 
+            QStringList sudoArguments;
+            sudoArguments << "--stdin" << "--prompt=" << "--";
+
+            // sudo resets the environment, so the profiler settings
+            // are handed over to the Perl interpreter by 'env':
+            if (scriptProfileDirectory.length() > 0) {
+                sudoArguments << "env"
+                              << "NYTPROF="
+                                 + scriptEnvironment.value("NYTPROF");
+            }
+
             scriptHandler.start(QString("sudo"),
-                                QStringList()
-                                << "--stdin"
-                                << "--prompt="
-                                << "--"
+                                sudoArguments
                                 << qApp->property("perlInterpreter").toString()
-                                << "-M-ops=fork"
-                                << scriptFullFilePath
+                                << interpreterArguments
                                 << scriptCommadLineArgument,
                                 QProcess::Unbuffered | QProcess::ReadWrite);
         }
@@ -746,15 +2731,247 @@ QNonInteractiveScriptHandler::QNonInteractiveScriptHandler(
 #endif
 #endif
 
+    if (scriptTimeoutSeconds > 0) {
+        scriptTimeoutTimer.setSingleShot(true);
+        scriptTimeoutTimer.start(scriptTimeoutSeconds * 1000);
+    }
+
+#ifdef Q_OS_LINUX
+    resourceSamplingTimer.start(500);
+#endif
+
     qDebug() << "Script started:" << scriptFullFilePath;
 }
 
+QNonInteractiveScriptHandler::~QNonInteractiveScriptHandler()
+{
+    QLiveObjects::destroyed("QNonInteractiveScriptHandler");
+}
+
+// ==============================
+// PROFILE REPORT HANDLER CONSTRUCTOR:
+// ==============================
+#if PERL_PROFILER_INTERACTION == 1
+QProfileReportHandler::QProfileReportHandler(QString profileDirectory)
+    : QObject(0)
+{
+    QLiveObjects::created("QProfileReportHandler");
+
+    QObject::connect(&reportHandler,
+                     SIGNAL(finished(int, QProcess::ExitStatus)),
+                     this,
+                     SLOT(qReportFinishedSlot(int, QProcess::ExitStatus)));
+#if QT_VERSION >= 0x050600
+    QObject::connect(&reportHandler,
+                     SIGNAL(errorOccurred(QProcess::ProcessError)),
+                     this,
+                     SLOT(qReportErrorSlot(QProcess::ProcessError)));
+#else
+    QObject::connect(&reportHandler,
+                     SIGNAL(error(QProcess::ProcessError)),
+                     this,
+                     SLOT(qReportErrorSlot(QProcess::ProcessError)));
+#endif
+
+    reportDirectory = QDir::toNativeSeparators(
+                profileDirectory + QDir::separator() + "nytprof");
+
+    // 'nytprofhtml' is installed together with Devel::NYTProf,
+    // usually in the directory of the Perl interpreter:
+    QString perlInterpreter = qApp->property("perlInterpreter").toString();
+    QString nytprofhtmlFullFilePath = QDir::toNativeSeparators(
+                QFileInfo(perlInterpreter).absolutePath()
+                + QDir::separator() + "nytprofhtml");
+
+    QStringList reportArguments;
+    reportArguments << "--file"
+                    << profileDirectory + QDir::separator() + "nytprof.out"
+                    << "--out"
+                    << reportDirectory;
+
+    reportHandler.setWorkingDirectory(profileDirectory);
+
+    if (QFile(nytprofhtmlFullFilePath).exists()) {
+        reportHandler.start(perlInterpreter,
+                            QStringList()
+                            << nytprofhtmlFullFilePath
+                            << reportArguments);
+    } else {
+        reportHandler.start("nytprofhtml", reportArguments);
+    }
+
+    qDebug() << "Profile report started:" << reportDirectory;
+}
+
+QProfileReportHandler::~QProfileReportHandler()
+{
+    QLiveObjects::destroyed("QProfileReportHandler");
+}
+
+QTemporaryDir *QProfileReportHandler::reportsDirectory = 0;
+
+// Reports are trusted pages, so they are written only in
+// a private directory of the current user with an unpredictable name.
+// Returns an empty string if no such directory is available:
+QString QProfileReportHandler::qReportsDirectory()
+{
+    if (reportsDirectory == 0) {
+        reportsDirectory =
+                new QTemporaryDir(QDir::tempPath() + "/peb-nytprof-XXXXXX");
+    }
+
+    if (!reportsDirectory->isValid() or
+            !qIsPrivateDirectory(reportsDirectory->path())) {
+        qDebug() << "Profile reports directory is not private:"
+                 << reportsDirectory->path();
+        return QString();
+    }
+
+    return QDir::cleanPath(reportsDirectory->path());
+}
+
+// Only the current user may own, read, write or enter the directory:
+bool QProfileReportHandler::qIsPrivateDirectory(QString path)
+{
+    QFileInfo directoryInfo(path);
+
+    if (!directoryInfo.isDir() or directoryInfo.isSymLink()) {
+        return false;
+    }
+
+#ifndef Q_OS_WIN
+    if (directoryInfo.ownerId() != getuid()) {
+        return false;
+    }
+
+    if (directoryInfo.permissions() &
+            (QFile::ReadGroup | QFile::WriteGroup | QFile::ExeGroup |
+             QFile::ReadOther | QFile::WriteOther | QFile::ExeOther)) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void QProfileReportHandler::qCleanup()
+{
+    delete reportsDirectory;
+    reportsDirectory = 0;
+}
+
+// Report URLs are mapped to files inside the reports directory only:
+QString QProfileReportHandler::qReportFilePath(QUrl url)
+{
+    QString reportsDirectoryPath = qReportsDirectory();
+    if (reportsDirectoryPath.length() == 0) {
+        return QString();
+    }
+
+    QString reportFilePath = QDir::cleanPath(
+                reportsDirectoryPath + "/"
+                + url.path().mid(QString("/peb-nytprof/").length()));
+
+    if (!reportFilePath.startsWith(reportsDirectoryPath + "/")) {
+        return QString();
+    }
+
+    return QDir::toNativeSeparators(reportFilePath);
+}
+
+QUrl QProfileReportHandler::qReportUrl(QString reportFilePath)
+{
+    QString relativeFilePath = QDir(qReportsDirectory()).relativeFilePath(
+                QDir::fromNativeSeparators(reportFilePath));
+
+    return QUrl(QString("http://") + PSEUDO_DOMAIN
+                + "/peb-nytprof/" + relativeFilePath);
+}
+
+// ==============================
+// PROFILER CHECK:
+// ==============================
+QProfilerCheck *QProfilerCheck::sharedCheck = 0;
+
+QProfilerCheck::QProfilerCheck()
+    : QObject(0)
+{
+    finished = false;
+    available = false;
+
+    QObject::connect(&checkProcess,
+                     SIGNAL(finished(int, QProcess::ExitStatus)),
+                     this,
+                     SLOT(qCheckFinishedSlot(int, QProcess::ExitStatus)));
+#if QT_VERSION >= 0x050600
+    QObject::connect(&checkProcess,
+                     SIGNAL(errorOccurred(QProcess::ProcessError)),
+                     this,
+                     SLOT(qCheckErrorSlot(QProcess::ProcessError)));
+#else
+    QObject::connect(&checkProcess,
+                     SIGNAL(error(QProcess::ProcessError)),
+                     this,
+                     SLOT(qCheckErrorSlot(QProcess::ProcessError)));
+#endif
+}
+
+QProfilerCheck *QProfilerCheck::qSharedCheck()
+{
+    if (sharedCheck == 0) {
+        sharedCheck = new QProfilerCheck();
+        sharedCheck->setParent(qApp);
+    }
+
+    return sharedCheck;
+}
+
+void QProfilerCheck::qStart()
+{
+    if (finished or checkProcess.state() != QProcess::NotRunning) {
+        return;
+    }
+
+    checkProcess.start(qApp->property("perlInterpreter").toString(),
+                       QStringList()
+                       << "-MDevel::NYTProf::Data"
+                       << "-e"
+                       << "1");
+}
+
+bool QProfilerCheck::qIsFinished()
+{
+    return finished;
+}
+
+bool QProfilerCheck::qIsAvailable()
+{
+    return available;
+}
+
+void QProfilerCheck::qFinish(bool nytprofAvailable)
+{
+    if (finished) {
+        return;
+    }
+
+    finished = true;
+    available = nytprofAvailable;
+
+    qDebug() << "Devel::NYTProf available:" << available;
+
+    emit checkFinishedSignal();
+}
+#endif
+
 // ==============================
 // WEB PAGE CLASS CONSTRUCTOR:
 // ==============================
 QPage::QPage()
     : QWebPage(0)
 {
+    QLiveObjects::created("QPage");
+
     // QWebPage settings:
     QNetworkProxyFactory::setUseSystemConfiguration(true);
     QWebSettings::globalSettings()->
@@ -789,13 +3006,20 @@ QPage::QPage()
     // No download of files:
     setForwardUnsupportedContent(false);
 
-    // Disabled cache:
-    QWebSettings::setMaximumPagesInCache(0);
-    QWebSettings::setObjectCacheCapacities(0, 0, 0);
-
-    // Disabled history:
+    // Page cache is used only within its memory budget.
+    // The memory cache capacities are process-wide, not per page:
+    // all windows share one cache, which holds cacheable local assets and
+    // remote resources allowed by their own headers. Script output and
+    // other generated replies are marked 'no-store' and are never cached:
+    QWebSettings::setMaximumPagesInCache(QPageCacheBudget::capacity());
+    QWebSettings::setObjectCacheCapacities(
+                0,
+                OBJECT_CACHE_CAPACITY * 1024 * 1024 / 2,
+                OBJECT_CACHE_CAPACITY * 1024 * 1024);
+
+    // History is limited to the pages, which can be cached:
     QWebHistory *history = this->history();
-    history->setMaximumItemCount(0);
+    history->setMaximumItemCount(PAGE_CACHE_PAGES);
 
     // Scroll bars:
     mainFrame()->setScrollBarPolicy(Qt::Horizontal,
@@ -817,12 +3041,13 @@ QPage::QPage()
     yesLabel = "Yes";
     noLabel = "No";
 
-    // Initialization of a modified Network Access Manager:
-    QAccessManager *networkAccessManager = new QAccessManager();
+    // The status of a new page is unknown until its first content is loaded:
+    pageStatus = PageStatusUnknown;
 
-    // Cookies and HTTPS support:
-    QNetworkCookieJar *cookieJar = new QNetworkCookieJar;
-    networkAccessManager->setCookieJar(cookieJar);
+    // All pages use one modified Network Access Manager,
+    // so that connections and TLS sessions are reused across windows:
+    QAccessManager *networkAccessManager =
+            QAccessManager::qSharedAccessManager();
 
     // Using the modified Network Access Manager:
     setNetworkAccessManager(networkAccessManager);
@@ -841,15 +3066,20 @@ QPage::QPage()
 
     // Signal and slot for the detection of page status:
     QObject::connect(this,
-                     SIGNAL(pageStatusSignal(QString)),
+                     SIGNAL(pageStatusSignal(QPageStatus)),
+                     networkAccessManager,
+                     SLOT(qPageStatusSlot(QPageStatus)));
+
+    QObject::connect(this,
+                     SIGNAL(destroyed(QObject*)),
                      networkAccessManager,
-                     SLOT(qPageStatusSlot(QString)));
+                     SLOT(qPageDestroyedSlot(QObject*)));
 
     // Signal and slot for starting local scripts:
     QObject::connect(networkAccessManager,
-                     SIGNAL(startScriptSignal(QUrl, QByteArray)),
+                     SIGNAL(startScriptSignal(QWebPage*, QUrl, QByteArray)),
                      this,
-                     SLOT(qStartScriptSlot(QUrl, QByteArray)));
+                     SLOT(qStartScriptSlot(QWebPage*, QUrl, QByteArray)));
 
     // Signals and slots for the interactive script handler:
     QObject::connect(&interactiveScriptHandler,
@@ -866,42 +3096,118 @@ QPage::QPage()
                      this, SLOT(qCloseInteractiveScriptSlot()));
 
     // Signal and slot for closing window:
-    QObject::connect(networkAccessManager, SIGNAL(closeWindowSignal()),
-                     this, SLOT(qCloseWindowTransmitterSlot()));
+    QObject::connect(networkAccessManager,
+                     SIGNAL(closeWindowSignal(QWebPage*)),
+                     this, SLOT(qCloseWindowTransmitterSlot(QWebPage*)));
 
     // Signals and slots for actions taken after page is loaded:
     QObject::connect(this, SIGNAL(loadFinished(bool)),
                      this, SLOT(qPageLoadedSlot(bool)));
 
+#if PREFETCH_BUDGET > 0
+    // Signal and slot for cancelling prefetching on navigation:
+    QObject::connect(this, SIGNAL(loadStarted()),
+                     this, SLOT(qPageLoadStartedSlot()));
+#endif
+
     // Signals and slots for the Perl debugger:
 #if PERL_DEBUGGER_INTERACTION == 1
     QObject::connect(&debuggerHandler, SIGNAL(readyReadStandardOutput()),
-                     this, SLOT(qDebuggerOutputSlot()));
-
-    QObject::connect(&debuggerOutputHandler,
-                     SIGNAL(readyReadStandardOutput()),
-                     this,
-                     SLOT(qDebuggerHtmlFormatterOutputSlot()));
-    QObject::connect(&debuggerOutputHandler,
-                     SIGNAL(readyReadStandardError()),
-                     this,
-                     SLOT(qDebuggerHtmlFormatterErrorsSlot()));
-    QObject::connect(&debuggerOutputHandler,
+                     this, SLOT(qDebuggerScriptOutputSlot()));
+    QObject::connect(&debuggerHandler,
                      SIGNAL(finished(int, QProcess::ExitStatus)),
-                     this,
-                     SLOT(qDebuggerHtmlFormatterFinishedSlot()));
+                     this, SLOT(qDebuggerFinishedSlot()));
+    QObject::connect(&debuggerServer, SIGNAL(newConnection()),
+                     this, SLOT(qDebuggerConnectedSlot()));
 
-    // Explicit initialization of important perl-debugger-related value:
+    // Explicit initialization of important perl-debugger-related values:
     debuggerJustStarted = false;
+    debuggerSocket = 0;
+    debuggerDecoder = 0;
+    debuggerScriptDecoder = 0;
+    debuggerPromptsReceived = 0;
+    debuggerDisplayedOutputLength = 0;
+    debuggerEmptyOutputLines = 0;
+    debuggerCurrentLine = 0;
+    debuggerViewLoading = false;
+#endif
+}
+
+QPage::~QPage()
+{
+#if PERL_DEBUGGER_INTERACTION == 1
+    delete debuggerDecoder;
+    delete debuggerScriptDecoder;
+#endif
+
+    QExecutionStatistics::dequeued("archive-extraction-scripts",
+                                   extractionWaitingScripts.length());
+
+#if PERL_PROFILER_INTERACTION == 1
+    QExecutionStatistics::dequeued("profiled-scripts",
+                                   profiledScriptsQueue.length());
+#endif
+
+    QLiveObjects::destroyed("QPage");
+}
+
+// ==============================
+// SHARED NETWORK ACCESS MANAGER:
+// ==============================
+QAccessManager *QAccessManager::sharedAccessManager = 0;
+
+QAccessManager *QAccessManager::qSharedAccessManager()
+{
+    if (sharedAccessManager == 0) {
+        // The application owns the shared access manager,
+        // pages only use it:
+        sharedAccessManager = new QAccessManager();
+        sharedAccessManager->setParent(qApp);
+
+        // Cookies and HTTPS support:
+        QNetworkCookieJar *cookieJar = new QNetworkCookieJar;
+        sharedAccessManager->setCookieJar(cookieJar);
+
+#if DISK_CACHE_SIZE > 0
+        // Disk cache for trusted remote domains:
+        QNetworkDiskCache *diskCache = new QNetworkDiskCache;
+        diskCache->setCacheDirectory(
+                    QStandardPaths::writableLocation(
+                        QStandardPaths::DataLocation)
+                    + QDir::separator() + "network-cache");
+        diskCache->setMaximumCacheSize(
+                    (qint64) DISK_CACHE_SIZE * 1024 * 1024);
+        sharedAccessManager->setCache(diskCache);
+
+        QObject::connect(sharedAccessManager,
+                         SIGNAL(finished(QNetworkReply*)),
+                         sharedAccessManager,
+                         SLOT(qDiskCacheStatisticsSlot(QNetworkReply*)));
+#endif
+
+        // Signal and slot for the invalidation of cached local files:
+#if OBJECT_CACHE_CAPACITY > 0
+        if (QApplicationFileIndex::qSharedFileIndex() != 0) {
+            QObject::connect(QApplicationFileIndex::qSharedFileIndex(),
+                             SIGNAL(fileChangedSignal(QString)),
+                             sharedAccessManager,
+                             SLOT(qAssetChangedSlot(QString)));
+        }
 #endif
+    }
+
+    return sharedAccessManager;
 }
 
 // ==============================
 // WEB VIEW CLASS CONSTRUCTOR:
 // ==============================
-QWebViewWidget::QWebViewWidget()
+// Spare windows are counted separately until they are displayed:
+QWebViewWidget::QWebViewWidget(bool spare)
     : QWebView(0)
 {
+    QLiveObjects::created(spare ? "QWebViewWidget-spare" : "QWebViewWidget");
+
     // Keyboard shortcuts:
 #ifndef QT_NO_PRINTER
     QShortcut *printShortcut = new QShortcut(QKeySequence("Ctrl+P"), this);
@@ -914,8 +3220,10 @@ QWebViewWidget::QWebViewWidget()
     QObject::connect(qWebInspestorShortcut, SIGNAL(activated()),
                      this, SLOT(qStartQWebInspector()));
 
-    // Starting of a QPage instance:
+    // Starting of a QPage instance,
+    // the page is deleted together with its view:
     mainPage = new QPage();
+    mainPage->setParent(this);
 
     // Signal and slot for displaying script errors:
     QObject::connect(mainPage, SIGNAL(displayScriptErrorsSignal(QString)),
@@ -951,6 +3259,57 @@ QWebViewWidget::QWebViewWidget()
     windowCloseRequested = false;
 }
 
+QWebViewWidget::~QWebViewWidget()
+{
+    QLiveObjects::destroyed(this == spareWindow ?
+                                "QWebViewWidget-spare" : "QWebViewWidget");
+}
+
+// ==============================
+// SPARE WINDOW:
+// ==============================
+QWebViewWidget *QWebViewWidget::spareWindow = 0;
+
+// Returns the prepared spare window or
+// a new window, if no spare window is available:
+QWebViewWidget *QWebViewWidget::qTakeSpareWindow()
+{
+    QWebViewWidget *window = spareWindow;
+    spareWindow = 0;
+
+    if (window != 0) {
+        QLiveObjects::moved("QWebViewWidget-spare", "QWebViewWidget");
+        QExecutionStatistics::increment("spare-window-hits");
+        return window;
+    }
+
+    QExecutionStatistics::increment("spare-window-misses");
+
+    window = new QWebViewWidget();
+    window->setHtml(qLoadingPageContents());
+
+    return window;
+}
+
+bool QWebViewWidget::qIsSpareWindow(QWebViewWidget *window)
+{
+    return (window != 0 and window == spareWindow);
+}
+
+// The hidden spare window is never closed by the user,
+// it is deleted before application exit:
+void QWebViewWidget::qDeleteSpareWindow()
+{
+    delete spareWindow;
+    spareWindow = 0;
+}
+
+// The embedded loading page is read only once:
+QString QWebViewWidget::qLoadingPageContents()
+{
+    return QPageTemplate::qRender(":/html/loading.html");
+}
+
 // ==============================
 // EXIT HANDLER CONSTRUCTOR:
 // ==============================
@@ -971,11 +3330,9 @@ bool QPage::acceptNavigationRequest(QWebFrame *frame,
     // Untrusted domains called from a trusted page
     // are loaded in new browser windows:
     // ==============================
-    QStringList trustedDomains =
-            qApp->property("trustedDomains").toStringList();
-
-    if (pageStatus == "trusted" and
-            (!trustedDomains.contains(request.url().authority())) and
+    if (pageStatus == PageStatusTrusted and
+            (!QTrustedDomains::contains(
+                 request.url().host().toLower())) and
             (request.url().fileName().length() == 0 or
              request.url().fileName().contains(htmlFileNameExtensionMarker))) {
         QWebPage *page =
@@ -995,7 +3352,7 @@ bool QPage::acceptNavigationRequest(QWebFrame *frame,
             mainFrame()->setUrl(request.url());
         }
 
-        if (pageStatus == "trusted") {
+        if (pageStatus == PageStatusTrusted) {
             // ==============================
             // User selected single file:
             // ==============================
@@ -1075,13 +3432,10 @@ bool QPage::acceptNavigationRequest(QWebFrame *frame,
             if (navigationType == QWebPage::NavigationTypeLinkClicked and
                     request.url().fileName() == "about.function" and
                     request.url().query() == "type=browser") {
-                QFileReader *resourceReader =
-                        new QFileReader(QString(":/html/about.html"));
-                QString aboutPageContents = resourceReader->fileContents;
-
-                aboutPageContents
-                        .replace("VERSION_STRING",
-                                 QApplication::applicationVersion().toLatin1());
+                QString aboutPageContents =
+                        QPageTemplate::qRender(
+                            ":/html/about.html", "VERSION_STRING",
+                            QApplication::applicationVersion());
 
                 frame->setHtml(aboutPageContents);
 
@@ -1158,7 +3512,7 @@ bool QPage::acceptNavigationRequest(QWebFrame *frame,
 #endif
         }
 
-        if (pageStatus == "untrusted") {
+        if (pageStatus == PageStatusUntrusted) {
             qMixedContentWarning(request.url());
         }
     }
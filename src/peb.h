@@ -30,6 +30,14 @@
 #include <QWebFrame>
 #include <QWebInspector>
 #include <QProcess>
+#include <QThreadPool>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextCodec>
+#include <QUuid>
+#include <QLocalServer>
+#include <QLocalSocket>
 #include <QFileDialog>
 #include <QInputDialog>
 #include <QMessageBox>
@@ -37,8 +45,17 @@
 #include <QDesktopWidget>
 #include <qglobal.h>
 
+#include "perl-syntax-highlighter.h"
+#include "execution-statistics.h"
+#include "file-index.h"
+
 #include <QMenu>
 
+#ifndef Q_OS_WIN
+#include <unistd.h> // for sysconf() and setpgid()
+#include <signal.h> // for kill()
+#endif
+
 // ==============================
 // PRINT SUPPORT:
 // ==============================
@@ -55,6 +72,117 @@
 #define PSEUDO_DOMAIN "local-pseudodomain"
 #endif
 
+// ==============================
+// NONINTERACTIVE SCRIPT RESOURCE LIMITS:
+// Values are set in the project file, 0 means no limit
+// ==============================
+#ifndef SCRIPT_TIMEOUT
+#define SCRIPT_TIMEOUT 0
+#endif
+
+// Milliseconds between SIGTERM and SIGKILL for a timed out script:
+#ifndef SCRIPT_KILL_DELAY
+#define SCRIPT_KILL_DELAY 2000
+#endif
+
+#ifndef SCRIPT_CPU_TIME_LIMIT
+#define SCRIPT_CPU_TIME_LIMIT 0
+#endif
+
+#ifndef SCRIPT_MEMORY_LIMIT
+#define SCRIPT_MEMORY_LIMIT 0
+#endif
+
+// ==============================
+// PERL PROFILER INTERACTION:
+// ==============================
+#ifndef PERL_PROFILER_INTERACTION
+#define PERL_PROFILER_INTERACTION 1
+#endif
+
+// ==============================
+// OBJECT CACHE CAPACITY:
+// Megabytes of the WebKit memory cache, 0 disables it.
+// The cache is global - it is shared by all windows and
+// also keeps cacheable resources of trusted remote domains.
+// ==============================
+#ifndef OBJECT_CACHE_CAPACITY
+#define OBJECT_CACHE_CAPACITY 16
+#endif
+
+// ==============================
+// DISK CACHE:
+// Megabytes of the disk cache for trusted remote domains, 0 disables it
+// ==============================
+#ifndef DISK_CACHE_SIZE
+#define DISK_CACHE_SIZE 0
+#endif
+
+// ==============================
+// PAGE CACHE:
+// Maximal number of pages kept for back and forward navigation,
+// 0 disables history and page cache, and memory budget in megabytes
+// ==============================
+#ifndef PAGE_CACHE_PAGES
+#define PAGE_CACHE_PAGES 0
+#endif
+
+#ifndef PAGE_CACHE_MEMORY
+#define PAGE_CACHE_MEMORY 32
+#endif
+
+// ==============================
+// SINGLE INSTANCE MODE:
+// ==============================
+#ifndef SINGLE_INSTANCE
+#define SINGLE_INSTANCE 0
+#endif
+
+// ==============================
+// FIRST PAINT:
+// Maximal milliseconds the start page waits for the loading page
+// to be painted
+// ==============================
+#ifndef FIRST_PAINT_TIMEOUT
+#define FIRST_PAINT_TIMEOUT 500
+#endif
+
+// ==============================
+// SPARE WINDOW:
+// Milliseconds after startup or after a new window is opened,
+// before a new spare window is prepared
+// ==============================
+#ifndef SPARE_WINDOW_DELAY
+#define SPARE_WINDOW_DELAY 1000
+#endif
+
+// ==============================
+// ASYNCHRONOUS FILE READS:
+// Local files larger than this number of bytes are read
+// on a thread pool and are delivered in chunks
+// ==============================
+#ifndef ASYNC_READ_THRESHOLD
+#define ASYNC_READ_THRESHOLD 1048576
+#endif
+
+#ifndef ASYNC_READ_CHUNK_SIZE
+#define ASYNC_READ_CHUNK_SIZE 262144
+#endif
+
+// Maximal number of bytes read ahead of a streaming reply:
+#ifndef ASYNC_READ_BUFFER_SIZE
+#define ASYNC_READ_BUFFER_SIZE 1048576
+#endif
+
+// ==============================
+// PREFETCH:
+// Maximal number of local targets linked from a trusted page,
+// which are read in advance - 0 disables prefetching
+// ==============================
+#ifndef PREFETCH_BUDGET
+#define PREFETCH_BUDGET 0
+#endif
+
 // ==============================
 // FILE READER CLASS DEFINITION:
 // Usefull for both files inside binary resources and files on disk
@@ -65,9 +193,411 @@ class QFileReader : public QObject
 
 public:
     QFileReader(QString filePath);
+    ~QFileReader();
     QString fileContents;
 };
 
+// ==============================
+// PAGE TEMPLATE CLASS DEFINITION:
+// Built-in pages are parsed only once into
+// static chunks separated by placeholder slots
+// ==============================
+struct QParsedTemplate
+{
+    QStringList chunks;
+    int staticLength;
+};
+
+class QPageTemplate
+{
+public:
+    static QString qRender(QString resourcePath,
+                           QString placeholder = QString(),
+                           QString value = QString());
+    static QString qErrorPage(QString errorMessage);
+
+private:
+    static QHash<QString, QParsedTemplate> templates;
+};
+
+// ==============================
+// LIVE OBJECTS CLASS DEFINITION:
+// Debug builds count living instances of classes created
+// on every request, window or script, so that growth in
+// long sessions is visible - release builds count nothing
+// ==============================
+class QLiveObjects
+{
+public:
+    static void created(QString className);
+    static void destroyed(QString className);
+    static void moved(QString fromClassName, QString toClassName);
+
+    static QJsonObject toJson();
+
+private:
+    static QMutex mutex;
+    static QMap<QString, qint64> liveObjects;
+    static QMap<QString, qint64> createdObjects;
+};
+
+// ==============================
+// PAGE STATUS:
+// ==============================
+// A page is trusted or untrusted depending on the domain of
+// the first content loaded in it and
+// its status is unknown until then.
+enum QPageStatus {
+    PageStatusUnknown,
+    PageStatusTrusted,
+    PageStatusUntrusted
+};
+
+// ==============================
+// TRUSTED DOMAINS CLASS DEFINITION:
+// ==============================
+// Trusted domains are set once at startup.
+// Exact domains are kept in a hash set and wildcard domains -
+// '*.example.com' - in a trie of their reversed labels.
+// Domains are compared with the lowercase host of an URL,
+// ports and user information are never part of a domain.
+struct QTrustedDomainNode
+{
+    QTrustedDomainNode();
+    QVector<QPair<QString, int> > children;
+    bool wildcard;
+};
+
+class QTrustedDomains
+{
+public:
+    static void setDomains(QStringList domains);
+    static bool contains(const QString &host);
+
+private:
+    static int qChild(int node, const QStringRef &label);
+
+    static QSet<QString> exactDomains;
+    static QVector<QTrustedDomainNode> wildcardTrie;
+};
+
+// ==============================
+// PAGE CACHE BUDGET CLASS DEFINITION:
+// ==============================
+// WebKit keeps whole pages for back and forward navigation,
+// but has no memory limit for them.
+// The number of cached pages is lowered whenever the estimated size of
+// the most recent pages exceeds the memory budget.
+class QPageCacheBudget
+{
+public:
+    static int capacity();
+    static void recordPage(qint64 bytes);
+
+private:
+    static QList<qint64> pageSizes;
+    static int currentCapacity;
+};
+
+// ==============================
+// APPLICATION ARCHIVE CLASS DEFINITION:
+// ==============================
+// A packed application - resources/app.rcc made by 'rcc --binary' -
+// is memory mapped and its static files are served directly from it.
+// Perl can not read the archive, so it is extracted in a temporary
+// directory on a background thread started during application startup.
+class QArchiveExtractor : public QThread
+{
+    Q_OBJECT
+
+public:
+    QArchiveExtractor(QString root, QString target);
+
+protected:
+    void run();
+
+private:
+    QString rootDirectory;
+    QString targetDirectory;
+};
+
+class QApplicationArchive
+{
+public:
+    static bool qRegister(QString archivePath);
+    static void qStartExtraction();
+    static QString qRoot();
+    static QString qFilePath(QString relativePath);
+    static QString qScriptsDirectory();
+    static bool qWhenExtracted(QObject *receiver, const char *slot);
+    static void qCleanup();
+
+private:
+    static bool packed;
+    static QString archive;
+    static QTemporaryDir *extractionDirectory;
+    static QArchiveExtractor *extractor;
+};
+
+// ==============================
+// STARTUP TIMER CLASS DEFINITION:
+// ==============================
+// Every startup phase is measured from the end of the previous phase and
+// a timing report is logged once the start page is loaded.
+class QStartupTimer : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void qStartPageLoadedSlot(bool ok)
+    {
+        QObject::disconnect(sender(), SIGNAL(loadFinished(bool)),
+                            this, SLOT(qStartPageLoadedSlot(bool)));
+
+        finishPhase("start-page-loading");
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "start page loaded"
+                 << (ok ? "successfully." : "with errors.");
+
+        report();
+    }
+
+public:
+    QStartupTimer();
+    void finishPhase(QString phase);
+    void report();
+
+private:
+    QElapsedTimer elapsedTimer;
+    qint64 lastPhaseEnd;
+    QStringList phases;
+    QList<qint64> phaseDurations;
+};
+
+// ==============================
+// PERL INTERPRETER LOCATOR CLASS DEFINITION:
+// ==============================
+// The full path of the Perl interpreter on PATH is cached in a state file
+// together with PATH and the modification time of the interpreter.
+// If the cached path is not valid anymore, the interpreter is
+// searched for in the background while the main window is created
+// and a signal is emitted when the search is over.
+class QPerlInterpreterLocator : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void interpreterFoundSignal(QString interpreter);
+
+public slots:
+    void qLocatorFinishedSlot()
+    {
+        if (searching == false) {
+            return;
+        }
+
+        interpreter = QString::fromLocal8Bit(
+                    locatorProcess.readAllStandardOutput()).trimmed();
+
+        qApp->setProperty("perlInterpreter", interpreter);
+
+        if (interpreter.length() > 0) {
+            qSaveState();
+        }
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "Perl interpreter found on PATH:" << interpreter;
+
+        searching = false;
+        emit interpreterFoundSignal(interpreter);
+    }
+
+    void qLocatorErrorSlot(QProcess::ProcessError error)
+    {
+        // A crashed process is also finished, but
+        // a process that failed to start is not:
+        if (searching == false or error != QProcess::FailedToStart) {
+            return;
+        }
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "no Perl interpreter can be started from PATH.";
+
+        searching = false;
+        emit interpreterFoundSignal(interpreter);
+    }
+
+public:
+    QPerlInterpreterLocator(QString privateInterpreter);
+    bool isSearching();
+    QString interpreter;
+
+private:
+    void qSaveState();
+
+    QProcess locatorProcess;
+    QString stateFilePath;
+    bool searching;
+};
+
+// ==============================
+// START PAGE LOADER CLASS DEFINITION:
+// ==============================
+// The embedded loading page is painted first and the start page is
+// resolved and loaded as soon as the Perl interpreter is known -
+// at once, if it is bundled or cached, or when the background search
+// is over. The first paint is the first paint event of the window
+// after the loading page is loaded. Startup is not blocked meanwhile and
+// the start page never waits longer than FIRST_PAINT_TIMEOUT msecs,
+// even if the loading page is not painted.
+class QStartPageLoader : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void qLoadingPageLoadedSlot(bool ok)
+    {
+        Q_UNUSED(ok);
+
+        QObject::disconnect(window, SIGNAL(loadFinished(bool)),
+                            this, SLOT(qLoadingPageLoadedSlot(bool)));
+
+        loadingPageLoaded = true;
+
+        // A paint event is requested even if the page is painted already:
+        window->update();
+    }
+
+    void qFirstPaintSlot()
+    {
+        if (firstPainted == true) {
+            return;
+        }
+
+        firstPainted = true;
+        firstPaintTimer.stop();
+        window->removeEventFilter(this);
+
+        if (paintReceived == false) {
+            qDebug() << QDateTime::currentMSecsSinceEpoch()
+                     << "msecs from epoch:"
+                     << "loading page not painted in"
+                     << FIRST_PAINT_TIMEOUT << "msecs, startup continues.";
+        }
+
+        startupTimer->finishPhase("first-paint");
+
+        if (interpreterFound == true) {
+            qLoadStartPage();
+        }
+    }
+
+    void qInterpreterFoundSlot(QString perlInterpreterFullPath)
+    {
+        interpreter = perlInterpreterFullPath;
+        interpreterFound = true;
+
+        if (firstPainted == true) {
+            qLoadStartPage();
+        }
+    }
+
+public:
+    QStartPageLoader();
+    void qStart();
+
+    QWebView *window;
+    QStartupTimer *startupTimer;
+    QString privateInterpreter;
+    QString applicationArchive;
+    QStringList trustedDomains;
+    bool startedAsRoot;
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event)
+    {
+        // The start page is loaded after the paint event is handled:
+        if (object == window and event->type() == QEvent::Paint and
+                loadingPageLoaded == true and paintReceived == false) {
+            paintReceived = true;
+            QTimer::singleShot(0, this, SLOT(qFirstPaintSlot()));
+        }
+
+        return QObject::eventFilter(object, event);
+    }
+
+private:
+    void qLoadStartPage();
+
+    QTimer firstPaintTimer;
+    QString interpreter;
+    bool interpreterFound;
+    bool loadingPageLoaded;
+    bool paintReceived;
+    bool firstPainted;
+};
+
+// ==============================
+// HIGHLIGHTED SOURCE CACHE CLASS DEFINITION:
+// ==============================
+// Syntax highlighted source code for the Perl debugger view is
+// cached by full file path and last modification time and
+// every file is highlighted only once while it is not modified.
+#if PERL_DEBUGGER_INTERACTION == 1
+struct QHighlightedSource
+{
+    QDateTime lastModified;
+    QString html;
+};
+
+class QHighlightedSourceCache
+{
+public:
+    static bool find(QString filePath, QString &html);
+    static void insert(QString filePath,
+                       QDateTime lastModified,
+                       QString html);
+
+private:
+    static QHash<QString, QHighlightedSource> entries;
+};
+
+// ==============================
+// PERL DEBUGGER PROMPT SCANNER CLASS DEFINITION:
+// ==============================
+// Finds Perl debugger command prompts like 'DB<1>' or 'DB<<2>>' in
+// the debugger output in a single pass over every output chunk.
+// Scanner state is kept between chunks, so that
+// a prompt split between two chunks is also found.
+class QDebuggerPromptScanner
+{
+public:
+    QDebuggerPromptScanner();
+    QList<int> scan(QString output);
+    void reset();
+
+private:
+    enum ScannerState {
+        Text,
+        PromptD,
+        PromptDB,
+        OpeningBrackets,
+        PromptDigits,
+        ClosingBrackets,
+        PromptEnd
+    };
+
+    ScannerState state;
+    int openingBrackets;
+    int closingBrackets;
+    int promptDigits;
+};
+#endif
+
 // ==============================
 // MAIN WINDOW CLASS DEFINITION:
 // ==============================
@@ -102,73 +632,394 @@ public:
 };
 
 // ==============================
-// NONINTERACTIVE SCRIPT HANDLER:
+// SCRIPT PROCESS CLASS DEFINITION:
+// QProcess applying resource limits in the child process
+// ==============================
+class QScriptProcess : public QProcess
+{
+    Q_OBJECT
+
+public:
+    QScriptProcess();
+    qint64 cpuTimeLimit;
+    qint64 memoryLimit;
+
+protected:
+    void setupChildProcess();
+};
+
+// ==============================
+// NONINTERACTIVE SCRIPT HANDLER:
+// ==============================
+class QNonInteractiveScriptHandler : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void displayScriptOutputSignal(QString output, QString scriptOutputTarget);
+    void scriptFinishedSignal(QString scriptAccumulatedOutput,
+                              QString scriptAccumulatedErrors,
+                              QString scriptFullFilePath,
+                              QString scriptOutputTarget,
+                              bool scriptTerminated);
+    void scriptProfiledSignal(QString profileDirectory);
+
+public slots:
+    void qNonInteractiveScriptStartedSlot()
+    {
+        if (scriptPrefetched == false) {
+            QExecutionStatistics::scriptStarted();
+        }
+        QExecutionStatistics::recordLatency(qStatistic("spawn-time"),
+                                            scriptElapsedTimer.elapsed());
+    }
+
+    void qNonInteractiveScriptOutputSlot()
+    {
+        QByteArray outputArray = scriptHandler.readAllStandardOutput();
+        QString output = outputArray;
+        scriptAccumulatedOutput.append(output);
+
+        if (scriptFirstOutputReceived == false) {
+            scriptFirstOutputReceived = true;
+            QExecutionStatistics::recordLatency(
+                        qStatistic("time-to-first-byte"),
+                        scriptElapsedTimer.elapsed());
+        }
+        QExecutionStatistics::increment(qStatistic("script-bytes-out"),
+                                        outputArray.size());
+
+        if (scriptOutputTarget.length() > 0) {
+            emit displayScriptOutputSignal(output, scriptOutputTarget);
+        }
+
+        qSampleResourceUsageSlot();
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: output from" << scriptFullFilePath;
+    }
+
+    void qNonInteractiveScriptErrorsSlot()
+    {
+        QString scriptErrors = scriptHandler.readAllStandardError();
+        scriptAccumulatedErrors.append(scriptErrors);
+        scriptAccumulatedErrors.append("\n");
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: errors from" << scriptFullFilePath;
+
+        // qDebug() << "Script errors:" << scriptErrors;
+    }
+
+    void qNonInteractiveScriptFinishedSlot(int exitCode,
+                                           QProcess::ExitStatus exitStatus)
+    {
+        scriptTimeoutTimer.stop();
+        resourceSamplingTimer.stop();
+
+        if (scriptTimedOut == true) {
+            scriptAccumulatedErrors.append(
+                        "Script was terminated after its wall-clock timeout of "
+                        + QString::number(scriptTimeoutSeconds)
+                        + " seconds expired.\n");
+        }
+
+        if (scriptTimedOut == false and
+                exitStatus == QProcess::CrashExit) {
+            QString terminationMessage =
+                    "Script was terminated abnormally.";
+            if (scriptHandler.cpuTimeLimit > 0) {
+                terminationMessage.append(
+                            " Its CPU time limit of "
+                            + QString::number(scriptHandler.cpuTimeLimit)
+                            + " seconds may have been exceeded.");
+            }
+            scriptAccumulatedErrors.append(terminationMessage + "\n");
+        }
+
+        emit scriptFinishedSignal(scriptAccumulatedOutput,
+                                  scriptAccumulatedErrors,
+                                  scriptFullFilePath,
+                                  scriptOutputTarget,
+                                  (scriptTimedOut == true or
+                                   exitStatus == QProcess::CrashExit));
+
+        if (scriptProfileDirectory.length() > 0) {
+            emit scriptProfiledSignal(scriptProfileDirectory);
+        }
+
+        scriptHandler.close();
+
+        QExecutionStatistics::recordLatency(qStatistic("total-duration"),
+                                            scriptElapsedTimer.elapsed());
+        if (scriptPrefetched == false) {
+            QExecutionStatistics::scriptFinished();
+            if (exitStatus == QProcess::CrashExit) {
+                QExecutionStatistics::recordExitCode("crash");
+            } else {
+                QExecutionStatistics::recordExitCode(
+                            QString::number(exitCode));
+            }
+        }
+
+        qDebug() << "Script finished:" << scriptFullFilePath
+                 << "exit code:" << exitCode;
+
+        if (scriptPeakResidentKilobytes >= 0) {
+            qDebug() << "Script resource usage:" << scriptFullFilePath
+                     << "peak RSS:" << scriptPeakResidentKilobytes << "kB,"
+                     << "CPU time:" << scriptCpuTimeMilliseconds << "msecs";
+        }
+    }
+
+    void qScriptTimeoutSlot()
+    {
+        if (scriptHandler.state() != QProcess::NotRunning) {
+            scriptTimedOut = true;
+
+#ifndef Q_OS_WIN
+            // The script is the leader of its own process group and
+            // the whole group is terminated. A script started by sudo
+            // runs as root and can not be signalled by PEB, but
+            // sudo relays SIGTERM to it before it is killed.
+            // A process which is still starting has no valid group yet and
+            // 'kill(0, ...)' would signal the group of PEB itself:
+            if (scriptHandler.state() == QProcess::Running and
+                    scriptHandler.pid() > 0) {
+                ::kill(-scriptHandler.pid(), SIGTERM);
+                QTimer::singleShot(SCRIPT_KILL_DELAY, this,
+                                   SLOT(qScriptKillSlot()));
+            } else {
+                scriptHandler.kill();
+            }
+#else
+            scriptHandler.kill();
+#endif
+
+            qDebug() << "Script timed out after"
+                     << scriptTimeoutSeconds << "seconds and"
+                     << "was forcefully terminated:" << scriptFullFilePath;
+        }
+    }
+
+    void qScriptKillSlot()
+    {
+#ifndef Q_OS_WIN
+        if (scriptHandler.state() == QProcess::Running and
+                scriptHandler.pid() > 0) {
+            ::kill(-scriptHandler.pid(), SIGKILL);
+        } else if (scriptHandler.state() != QProcess::NotRunning) {
+            scriptHandler.kill();
+        }
+#endif
+    }
+
+    void qSampleResourceUsageSlot()
+    {
+        // Peak RSS and CPU time are sampled from '/proc' while
+        // the script is running, because QProcess reaps the child
+        // and its resource usage can not be read after it exits.
+#ifdef Q_OS_LINUX
+        if (scriptHandler.state() != QProcess::Running) {
+            return;
+        }
+
+        QString procDirectory =
+                "/proc/" + QString::number(scriptHandler.pid());
+
+        QFile statFile(procDirectory + "/stat");
+        if (statFile.open(QIODevice::ReadOnly)) {
+            QByteArray stat = statFile.readAll();
+            statFile.close();
+
+            // Fields after the closing bracket of the command name
+            // start with the process state; utime and stime follow
+            // as 12th and 13th field:
+            QList<QByteArray> fields =
+                    stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+            if (fields.size() > 12) {
+                qint64 clockTicks = sysconf(_SC_CLK_TCK);
+                if (clockTicks > 0) {
+                    scriptCpuTimeMilliseconds =
+                            (fields.at(11).toLongLong() +
+                             fields.at(12).toLongLong()) *
+                            1000 / clockTicks;
+                }
+            }
+        }
+
+        QFile statusFile(procDirectory + "/status");
+        if (statusFile.open(QIODevice::ReadOnly)) {
+            QList<QByteArray> statusLines = statusFile.readAll().split('\n');
+            statusFile.close();
+
+            foreach (QByteArray statusLine, statusLines) {
+                if (statusLine.startsWith("VmHWM:")) {
+                    qint64 peakResidentKilobytes =
+                            statusLine.mid(6).replace("kB", "")
+                            .trimmed().toLongLong();
+                    if (peakResidentKilobytes >
+                            scriptPeakResidentKilobytes) {
+                        scriptPeakResidentKilobytes = peakResidentKilobytes;
+                    }
+                    break;
+                }
+            }
+        }
+#endif
+    }
+
+    void qRootPasswordTimeoutSlot()
+    {
+        qApp->setProperty("rootPassword", "");
+    }
+
+    void qStartScriptSlot();
+
+public:
+    QNonInteractiveScriptHandler(QUrl url, QByteArray postDataArray,
+                                 bool prefetched = false);
+    ~QNonInteractiveScriptHandler();
+    QString scriptAccumulatedOutput;
+    QString scriptAccumulatedErrors;
+
+private:
+    // Scripts run in advance by the prefetch engine have
+    // their own counters and histograms and are not counted as running
+    // scripts, so that they do not inflate the statistics of launches:
+    QString qStatistic(QString name)
+    {
+        return (scriptPrefetched == true) ? "prefetch-" + name : name;
+    }
+
+    bool scriptPrefetched;
+    bool scriptStarted;
+    QUrl scriptUrl;
+    QByteArray scriptPostDataArray;
+    QScriptProcess scriptHandler;
+    QString scriptFullFilePath;
+    QString scriptOutputTarget;
+    QString scriptUser;
+
+    int scriptTimeoutSeconds;
+    bool scriptTimedOut;
+    QTimer scriptTimeoutTimer;
+    QTimer resourceSamplingTimer;
+    qint64 scriptPeakResidentKilobytes;
+    qint64 scriptCpuTimeMilliseconds;
+
+    QElapsedTimer scriptElapsedTimer;
+    bool scriptFirstOutputReceived;
+
+    QString scriptProfileDirectory;
+};
+
+// ==============================
+// PROFILE REPORT HANDLER:
+// Generates HTML report from a Devel::NYTProf profile
+// ==============================
+#if PERL_PROFILER_INTERACTION == 1
+class QProfileReportHandler : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void reportReadySignal(QString reportIndexFilePath);
+
+public slots:
+    void qReportFinishedSlot(int exitCode, QProcess::ExitStatus exitStatus)
+    {
+        QString reportErrors = reportHandler.readAllStandardError();
+        QString reportIndexFilePath = QDir::toNativeSeparators(
+                    reportDirectory + QDir::separator() + "index.html");
+
+        if (exitStatus == QProcess::NormalExit and exitCode == 0 and
+                QFile(reportIndexFilePath).exists()) {
+            qDebug() << "Profile report finished:" << reportIndexFilePath;
+
+            emit reportReadySignal(reportIndexFilePath);
+        } else {
+            qDebug() << "Profile report failed:" << reportDirectory
+                     << reportErrors;
+        }
+
+        reportHandler.close();
+        deleteLater();
+    }
+
+    void qReportErrorSlot(QProcess::ProcessError error)
+    {
+        // 'finished' is not emitted if 'nytprofhtml' could not be started:
+        if (error == QProcess::FailedToStart) {
+            qDebug() << "Profile report could not be started:"
+                     << reportDirectory;
+
+            deleteLater();
+        }
+    }
+
+public:
+    QProfileReportHandler(QString profileDirectory);
+    ~QProfileReportHandler();
+
+    static QString qReportsDirectory();
+    static QString qReportFilePath(QUrl url);
+    static QUrl qReportUrl(QString reportFilePath);
+    static void qCleanup();
+
+private:
+    static bool qIsPrivateDirectory(QString path);
+
+    QProcess reportHandler;
+    QString reportDirectory;
+
+    static QTemporaryDir *reportsDirectory;
+};
+
+// ==============================
+// PROFILER CHECK:
+// Devel::NYTProf is looked for only once per browser session and
+// without blocking the GUI thread
 // ==============================
-class QNonInteractiveScriptHandler : public QObject
+class QProfilerCheck : public QObject
 {
     Q_OBJECT
 
 signals:
-    void displayScriptOutputSignal(QString output, QString scriptOutputTarget);
-    void scriptFinishedSignal(QString scriptAccumulatedOutput,
-                              QString scriptAccumulatedErrors,
-                              QString scriptFullFilePath,
-                              QString scriptOutputTarget);
+    void checkFinishedSignal();
 
 public slots:
-    void qNonInteractiveScriptOutputSlot()
+    void qCheckFinishedSlot(int exitCode, QProcess::ExitStatus exitStatus)
     {
-        QString output = scriptHandler.readAllStandardOutput();
-        scriptAccumulatedOutput.append(output);
-
-        if (scriptOutputTarget.length() > 0) {
-            emit displayScriptOutputSignal(output, scriptOutputTarget);
-        }
-
-        qDebug() << QDateTime::currentMSecsSinceEpoch()
-                 << "msecs from epoch: output from" << scriptFullFilePath;
+        qFinish(exitStatus == QProcess::NormalExit and exitCode == 0);
     }
 
-    void qNonInteractiveScriptErrorsSlot()
+    void qCheckErrorSlot(QProcess::ProcessError error)
     {
-        QString scriptErrors = scriptHandler.readAllStandardError();
-        scriptAccumulatedErrors.append(scriptErrors);
-        scriptAccumulatedErrors.append("\n");
-
-        qDebug() << QDateTime::currentMSecsSinceEpoch()
-                 << "msecs from epoch: errors from" << scriptFullFilePath;
-
-        // qDebug() << "Script errors:" << scriptErrors;
+        if (error == QProcess::FailedToStart) {
+            qFinish(false);
+        }
     }
 
-    void qNonInteractiveScriptFinishedSlot()
-    {
-        emit scriptFinishedSignal(scriptAccumulatedOutput,
-                                  scriptAccumulatedErrors,
-                                  scriptFullFilePath,
-                                  scriptOutputTarget);
+public:
+    QProfilerCheck();
 
-        scriptHandler.close();
+    static QProfilerCheck *qSharedCheck();
 
-        qDebug() << "Script finished:" << scriptFullFilePath;
-    }
+    void qStart();
+    bool qIsFinished();
+    bool qIsAvailable();
 
-    void qRootPasswordTimeoutSlot()
-    {
-        qApp->setProperty("rootPassword", "");
-    }
+private:
+    void qFinish(bool nytprofAvailable);
 
-public:
-    QNonInteractiveScriptHandler(QUrl url, QByteArray postDataArray);
-    QString scriptAccumulatedOutput;
-    QString scriptAccumulatedErrors;
+    QProcess checkProcess;
+    bool finished;
+    bool available;
 
-private:
-    QProcess scriptHandler;
-    QString scriptFullFilePath;
-    QString scriptOutputTarget;
-    QString scriptUser;
+    static QProfilerCheck *sharedCheck;
 };
+#endif
 
 // ==============================
 // CUSTOM NETWORK REPLY CLASS DEFINITION:
@@ -181,11 +1032,25 @@ public:
 
     QCustomNetworkReply(
             const QUrl &url, const QString &data, const QString &mime);
+    QCustomNetworkReply(
+            const QUrl &url, const QByteArray &data, const QString &mime);
+    QCustomNetworkReply(
+            const QUrl &url, const QString &filePath, const QString &mime,
+            const QIndexedFile &file);
     ~QCustomNetworkReply();
 
+    void qAppendChunk(QByteArray chunk);
+    void qFinishRead(bool success);
+
+    void qSetCacheHeaders(const QIndexedFile &file, bool revalidate);
+    void qSetNotModified(const QIndexedFile &file);
+    bool qSetByteRange(QString filePath, const QIndexedFile &file,
+                       QString mime, QByteArray range);
+
     void abort();
     qint64 bytesAvailable() const;
     bool isSequential() const;
+    bool seek(qint64 position);
     qint64 size() const;
 
 protected:
@@ -193,9 +1058,159 @@ protected:
     qint64 readData(char *data, qint64 maxSize);
 
 private:
+    void qSetContents(const QUrl &url, const QByteArray &data,
+                      const QString &mime);
+
     struct QCustomNetworkReplyPrivate *reply;
 };
 
+// ==============================
+// ASYNCHRONOUS FILE READER CLASS DEFINITION:
+// Large local files are read on a thread pool,
+// read chunks are delivered to their replies on the GUI thread
+// ==============================
+class QAsyncFileReader : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void fileReadSignal(int readId, QByteArray contents, bool success);
+
+public slots:
+    void qChunkReadSlot(int readId, QByteArray chunk)
+    {
+        QCustomNetworkReply *reply = replies.value(readId, 0);
+        if (reply != 0) {
+            reply->qAppendChunk(chunk);
+        }
+    }
+
+    void qReadFinishedSlot(int readId, bool success)
+    {
+        QCustomNetworkReply *reply = replies.take(readId);
+        if (reply != 0) {
+            reply->qFinishRead(success);
+        }
+
+        QMutexLocker locker(&mutex);
+        cancelledReads.remove(readId);
+        bufferedBytes.remove(readId);
+    }
+
+    void qFileReadSlot(int readId, QByteArray contents, bool success)
+    {
+        emit fileReadSignal(readId, contents, success);
+    }
+
+public:
+    QAsyncFileReader();
+    ~QAsyncFileReader();
+
+    static QAsyncFileReader *qSharedReader();
+
+    int qStartRead(QCustomNetworkReply *reply, QString filePath);
+    int qReadFile(QString filePath);
+    void qCancelRead(int readId);
+    bool qIsCancelled(int readId);
+
+    void qBufferChunk(int readId, qint64 bytes);
+    bool qPauseRead(int readId, QString filePath, qint64 position);
+    void qConsumeChunk(int readId, qint64 bytes);
+
+private:
+    QThreadPool threadPool;
+    QMutex mutex;
+    QHash<int, QCustomNetworkReply *> replies;
+    QSet<int> cancelledReads;
+    QHash<int, qint64> bufferedBytes;
+    QHash<int, QPair<QString, qint64> > pausedReads;
+    int lastReadId;
+
+    static QAsyncFileReader *sharedReader;
+};
+
+class QAsyncFileReadTask : public QRunnable
+{
+public:
+    QAsyncFileReadTask(QAsyncFileReader *reader, int readId,
+                       QString filePath, bool wholeFile,
+                       qint64 position = 0);
+    void run();
+
+private:
+    QAsyncFileReader *reader;
+    int readId;
+    QString filePath;
+    bool wholeFile;
+    qint64 position;
+};
+
+// ==============================
+// PREFETCH ENGINE CLASS DEFINITION:
+// Local files and prefetchable AJAX GET scripts linked from
+// trusted pages are read in advance and served from memory
+// ==============================
+struct QPrefetchedResource
+{
+    QByteArray contents;
+    QDateTime lastModified;
+    bool script;
+};
+
+class QPrefetchEngine : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void qPrefetchNextSlot();
+    void qFilePrefetchedSlot(int readId, QByteArray contents, bool success);
+    void qScriptPrefetchedSlot(QString scriptAccumulatedOutput,
+                               QString scriptAccumulatedErrors,
+                               QString scriptFullFilePath,
+                               QString scriptOutputTarget);
+
+    void qPageDestroyedSlot(QObject *page)
+    {
+        qCancel(page);
+        qDiscard(page);
+    }
+
+public:
+    QPrefetchEngine();
+
+    static QPrefetchEngine *qSharedEngine();
+
+    void qStart(QObject *page, QList<QUrl> urls, QSet<QString> markedUrls);
+    void qCancel(QObject *page);
+    void qDiscard(QObject *page);
+
+    bool qTakeFile(QObject *page, QUrl url, const QIndexedFile &file,
+                   QByteArray &contents);
+    bool qTakeScriptOutput(QObject *page, QUrl url, QString &output);
+
+private:
+    struct QPrefetchTask
+    {
+        QObject *page;
+        QUrl url;
+        bool script;
+        QIndexedFile file;
+    };
+
+    void qQueue(QObject *page, QUrl url, bool marked);
+    static QList<QUrl> qSubresources(QUrl pageUrl, QByteArray html);
+
+    QHash<QObject *, QHash<QString, QPrefetchedResource> > resources;
+    QHash<QObject *, QSet<QString> > queuedUrls;
+    QHash<QObject *, int> budgets;
+    QList<QPrefetchTask> tasks;
+    QPrefetchTask runningTask;
+    int runningReadId;
+    bool running;
+
+    static QPrefetchEngine *sharedEngine;
+};
+
 // ==============================
 // NETWORK ACCESS MANAGER
 // CLASS DEFINITION:
@@ -205,14 +1220,21 @@ class QAccessManager : public QNetworkAccessManager
     Q_OBJECT
 
 signals:
-    void startScriptSignal(QUrl url, QByteArray postDataArray);
-    void closeWindowSignal();
+    void startScriptSignal(QWebPage *page, QUrl url, QByteArray postDataArray);
+    void closeWindowSignal(QWebPage *page);
 
 protected:
     virtual QNetworkReply *createRequest(Operation operation,
                                          const QNetworkRequest &request,
                                          QIODevice *outgoingData = 0)
     {
+        // ==============================
+        // All pages share one access manager,
+        // page status is kept for every page separately:
+        // ==============================
+        QWebPage *page = qOriginatingPage(request);
+        QPageStatus pageStatus = pageStatuses.value(page, PageStatusUnknown);
+
         // ==============================
         // Case-insensitive marker for AJAX Perl scripts:
         // ==============================
@@ -227,7 +1249,7 @@ protected:
              operation == PostOperation) and
                 request.url().authority() == PSEUDO_DOMAIN and
                 request.url().path().contains(scriptAjaxMarker) and
-                pageStatus == "untrusted") {
+                pageStatus == PageStatusUntrusted) {
 
             QString errorMessage =
                     "Calling local Perl scripts after "
@@ -250,14 +1272,25 @@ protected:
              operation == PostOperation) and
                 request.url().authority() == PSEUDO_DOMAIN and
                 request.url().path().contains(scriptAjaxMarker) and
-                pageStatus == "trusted") {
-
-            QString ajaxScriptFullFilePath = QDir::toNativeSeparators
-                    ((qApp->property("application").toString())
-                     + request.url().path());
+                pageStatus == PageStatusTrusted) {
+
+            QString ajaxScriptFullFilePath =
+                    QApplicationArchive::qFilePath(request.url().path());
+
+            if (QApplicationFileIndex::qFile(ajaxScriptFullFilePath).exists) {
+#if PREFETCH_BUDGET > 0
+                // Output of prefetched GET scripts is served from memory:
+                QString prefetchedOutput;
+                if (operation == GetOperation and
+                        QPrefetchEngine::qSharedEngine()->qTakeScriptOutput(
+                            page, request.url(), prefetchedOutput)) {
+                    QCustomNetworkReply *reply =
+                            new QCustomNetworkReply (
+                                request.url(), prefetchedOutput, emptyString);
+                    return reply;
+                }
+#endif
 
-            QFile file(ajaxScriptFullFilePath);
-            if (file.exists()) {
                 QByteArray postDataArray;
                 if (outgoingData) {
                     postDataArray = outgoingData->readAll();
@@ -277,7 +1310,8 @@ protected:
                                  SIGNAL(scriptFinishedSignal(QString,
                                                              QString,
                                                              QString,
-                                                             QString)),
+                                                             QString,
+                                                             bool)),
                                  &ajaxScriptHandlerWaitingLoop,
                                  SLOT(quit()));
 
@@ -289,6 +1323,8 @@ protected:
                 QString ajaxScriptErrors =
                         ajaxScriptHandler->scriptAccumulatedErrors;
 
+                ajaxScriptHandler->deleteLater();
+
                 if (ajaxScriptOutput.length() == 0 and
                         ajaxScriptErrors == 0) {
                     qDebug() << "AJAX script timed out or gave no output:"
@@ -313,14 +1349,11 @@ protected:
             } else {
                 qDebug() << "File not found:" << ajaxScriptFullFilePath;
 
-                QFileReader *resourceReader =
-                        new QFileReader(QString(":/html/error.html"));
-                QString htmlErrorContents = resourceReader->fileContents;
-
                 QString errorMessage =
                         "<p>File not found:<br>"
                         + ajaxScriptFullFilePath + "</p>";
-                htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
+                QString htmlErrorContents =
+                        QPageTemplate::qErrorPage(errorMessage);
 
                 QString mimeType = "text/html";
 
@@ -331,6 +1364,49 @@ protected:
             }
         }
 
+#if PERL_PROFILER_INTERACTION == 1
+        // ==============================
+        // GET requests for Devel::NYTProf reports:
+        // reports are served from the private reports directory
+        // only to trusted pages - report windows are trusted by PEB:
+        // ==============================
+        if (operation == GetOperation and
+                request.url().authority() == PSEUDO_DOMAIN and
+                request.url().path().startsWith("/peb-nytprof/") and
+                pageStatus == PageStatusTrusted) {
+            QString reportFilePath =
+                    QProfileReportHandler::qReportFilePath(request.url());
+            QIndexedFile reportFile =
+                    QFileIndexBuilder::qIndexFile(QFileInfo(reportFilePath));
+
+            // Report files are read in the background and
+            // binary files like images are not converted:
+            if (reportFilePath.length() > 0 and reportFile.exists) {
+                QCustomNetworkReply *reply =
+                        new QCustomNetworkReply (
+                            request.url(), reportFilePath,
+                            reportFile.mimeType, reportFile);
+                return reply;
+            }
+
+            qDebug() << "Profile report file not found:"
+                     << request.url().toString();
+
+            QString errorMessage =
+                    "<p>Profile report file not found:<br>"
+                    + request.url().path().toHtmlEscaped() + "</p>";
+            QString htmlErrorContents =
+                    QPageTemplate::qErrorPage(errorMessage);
+
+            QString mimeType = "text/html";
+
+            QCustomNetworkReply *reply =
+                    new QCustomNetworkReply (
+                        request.url(), htmlErrorContents, mimeType);
+            return reply;
+        }
+#endif
+
         // ==============================
         // GET requests to the browser pseudodomain:
         // local files and non-AJAX scripts:
@@ -341,27 +1417,23 @@ protected:
                 (!request.url().path().contains(".function"))) {
 
             // Compose the full file path:
-            QString fullFilePath = QDir::toNativeSeparators
-                    ((qApp->property("application").toString())
-                     + request.url().path());
+            QString fullFilePath =
+                    QApplicationArchive::qFilePath(request.url().path());
 
             // Check if file exists:
-            QFile file(fullFilePath);
-            if (file.exists()) {
+            QIndexedFile file = QApplicationFileIndex::qFile(fullFilePath);
+            if (file.exists) {
                 // Get the MIME type of the local file:
-                QMimeDatabase mimeDatabase;
-                QMimeType type = mimeDatabase.mimeTypeForFile(fullFilePath);
-                // qDebug() << "MIME type:" << type.name();
-                QString mimeType = type.name();
+                QString mimeType = file.mimeType;
 
                 // Handle local Perl scripts:
                 if (mimeType == "application/x-perl") {
                     // Start local Perl scripts only if
                     // no untrusted content is loaded in the same window:
-                    if (pageStatus == "trusted") {
+                    if (pageStatus == PageStatusTrusted) {
                         QByteArray emptyPostDataArray;
                         emit startScriptSignal(
-                                    request.url(), emptyPostDataArray);
+                                    page, request.url(), emptyPostDataArray);
 
                         QCustomNetworkReply *reply =
                                 new QCustomNetworkReply (
@@ -372,7 +1444,7 @@ protected:
                     // If an attempt is made to start local Perl scripts after
                     // untrusted content is loaded in the same window,
                     //  an error page is displayed:
-                    if (pageStatus == "untrusted") {
+                    if (pageStatus == PageStatusUntrusted) {
                         QString errorMessage =
                                 "<p>Calling local Perl scripts after "
                                 "untrusted content is loaded in "
@@ -385,13 +1457,8 @@ protected:
                                  << "untrusted content was loaded:"
                                  << request.url().toString();
 
-                        QFileReader *resourceReader =
-                                new QFileReader(QString(":/html/error.html"));
                         QString htmlErrorContents =
-                                resourceReader->fileContents;
-
-                        htmlErrorContents
-                                .replace("ERROR_MESSAGE", errorMessage);
+                                QPageTemplate::qErrorPage(errorMessage);
 
                         QString mimeType = "text/html";
 
@@ -420,13 +1487,73 @@ protected:
                     qDebug() << "Local link requested:"
                              << request.url().toString();
 
-                    QFileReader *resourceReader =
-                            new QFileReader(QString(fullFilePath));
-                    QString fileContents = resourceReader->fileContents;
+#if OBJECT_CACHE_CAPACITY > 0
+                    // Unchanged files are not read again
+                    // when WebKit revalidates its cached copy:
+                    if (request.rawHeader("If-None-Match") ==
+                            file.qEntityTag()) {
+                        QExecutionStatistics::increment(
+                                    "object-cache-revalidations");
+
+                        QCustomNetworkReply *reply =
+                                new QCustomNetworkReply (
+                                    request.url(), emptyString, emptyString);
+                        reply->qSetNotModified(file);
+                        return reply;
+                    }
+#endif
+
+                    // Only the requested part of a local file is read
+                    // for range requests:
+                    if (request.hasRawHeader("Range")) {
+                        QCustomNetworkReply *reply =
+                                new QCustomNetworkReply (
+                                    request.url(), emptyString, emptyString);
+
+                        if (reply->qSetByteRange(
+                                    fullFilePath, file, mimeType,
+                                    request.rawHeader("Range"))) {
+                            return reply;
+                        }
+
+                        reply->deleteLater();
+                    }
+
+                    QCustomNetworkReply *reply = 0;
+
+#if PREFETCH_BUDGET > 0
+                    // Prefetched files are served from memory:
+                    QByteArray prefetchedContents;
+                    if (QPrefetchEngine::qSharedEngine()->qTakeFile(
+                                page, request.url(), file,
+                                prefetchedContents)) {
+                        reply = new QCustomNetworkReply (
+                                    request.url(), prefetchedContents,
+                                    mimeType);
+                    }
+#endif
+
+                    // Large files are not read on the GUI thread,
+                    // their reply is returned at once and is fed with
+                    // chunks of data as they are read:
+                    if (reply == 0 and file.size > ASYNC_READ_THRESHOLD) {
+                        reply = new QCustomNetworkReply (
+                                    request.url(), fullFilePath, mimeType,
+                                    file);
+                    } else if (reply == 0) {
+                        QFileReader resourceReader(fullFilePath);
+
+                        reply = new QCustomNetworkReply (
+                                    request.url(),
+                                    resourceReader.fileContents, mimeType);
+                    }
+
+#if OBJECT_CACHE_CAPACITY > 0
+                    // HTML pages are always revalidated,
+                    // other assets are fresh until their files are changed:
+                    reply->qSetCacheHeaders(file, (mimeType == "text/html"));
+#endif
 
-                    QCustomNetworkReply *reply =
-                            new QCustomNetworkReply (
-                                request.url(), fileContents, mimeType);
                     return reply;
                 } else {
                     qDebug() << "File type not supported:" << fullFilePath;
@@ -442,13 +1569,10 @@ protected:
             } else {
                 qDebug() << "File not found:" << fullFilePath;
 
-                QFileReader *resourceReader =
-                        new QFileReader(QString(":/html/error.html"));
-                QString htmlErrorContents = resourceReader->fileContents;
-
                 QString errorMessage =
                         "<p>File not found:<br>" + fullFilePath + "</p>";
-                htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
+                QString htmlErrorContents =
+                        QPageTemplate::qErrorPage(errorMessage);
 
                 QString mimeType = "text/html";
 
@@ -469,7 +1593,7 @@ protected:
 
             if (outgoingData) {
                 QByteArray postDataArray = outgoingData->readAll();
-                emit startScriptSignal(request.url(), postDataArray);
+                emit startScriptSignal(page, request.url(), postDataArray);
             }
 
             QCustomNetworkReply *reply =
@@ -478,13 +1602,65 @@ protected:
             return reply;
         }
 
+        // ==============================
+        // Execution statistics URL:
+        // ==============================
+        if (operation == GetOperation and
+                request.url().authority() == PSEUDO_DOMAIN and
+                request.url().fileName() == "statistics.function" and
+                pageStatus == PageStatusTrusted) {
+            QUrlQuery statisticsQuery(request.url());
+
+            if (statisticsQuery.queryItemValue("format") == "json") {
+                QJsonDocument statisticsJsonDocument(
+                            QExecutionStatistics::toJson());
+
+                QCustomNetworkReply *reply =
+                        new QCustomNetworkReply (
+                            request.url(),
+                            QString::fromUtf8(
+                                statisticsJsonDocument.toJson()),
+                            "application/json");
+                return reply;
+            }
+
+            QString statisticsContents =
+                    QPageTemplate::qRender(":/html/statistics.html",
+                                           "STATISTICS",
+                                           QExecutionStatistics::toHtml());
+
+            QCustomNetworkReply *reply =
+                    new QCustomNetworkReply (
+                        request.url(), statisticsContents, "text/html");
+            return reply;
+        }
+
+#ifndef QT_NO_DEBUG
+        // ==============================
+        // Live objects URL - debug builds only:
+        // ==============================
+        if (operation == GetOperation and
+                request.url().authority() == PSEUDO_DOMAIN and
+                request.url().fileName() == "live-objects.function" and
+                pageStatus == PageStatusTrusted) {
+            QJsonDocument liveObjectsJsonDocument(QLiveObjects::toJson());
+
+            QCustomNetworkReply *reply =
+                    new QCustomNetworkReply (
+                        request.url(),
+                        QString::fromUtf8(liveObjectsJsonDocument.toJson()),
+                        "application/json");
+            return reply;
+        }
+#endif
+
         // ==============================
         // Window closing URL:
         // ==============================
         if (operation == GetOperation and
                 request.url().fileName() == "close-window.function" and
-                pageStatus == "trusted") {
-            emit closeWindowSignal();
+                pageStatus == PageStatusTrusted) {
+            emit closeWindowSignal(page);
 
             QCustomNetworkReply *reply =
                     new QCustomNetworkReply (
@@ -495,22 +1671,84 @@ protected:
         qDebug() << "Link requested:"
                  << request.url().toString();
 
+        // Only trusted domains are cached on disk:
+        QNetworkRequest networkRequest(request);
+        if (!QTrustedDomains::contains(
+                    request.url().host().toLower())) {
+            networkRequest.setAttribute(
+                        QNetworkRequest::CacheLoadControlAttribute,
+                        QNetworkRequest::AlwaysNetwork);
+            networkRequest.setAttribute(
+                        QNetworkRequest::CacheSaveControlAttribute, false);
+        }
+
         return QNetworkAccessManager::createRequest
                 (QNetworkAccessManager::GetOperation,
-                 QNetworkRequest(request));
+                 networkRequest);
     }
 
 public slots:
-    void qPageStatusSlot(QString pageStatusTransmitted)
+    void qPageStatusSlot(QPageStatus pageStatusTransmitted)
+    {
+        pageStatuses.insert(sender(), pageStatusTransmitted);
+    }
+
+    void qPageDestroyedSlot(QObject *page)
+    {
+        pageStatuses.remove(page);
+    }
+
+    void qDiskCacheStatisticsSlot(QNetworkReply *reply)
+    {
+        if (reply->url().authority() == PSEUDO_DOMAIN or
+                !QTrustedDomains::contains(
+                    reply->url().host().toLower())) {
+            return;
+        }
+
+        if (reply->attribute(
+                    QNetworkRequest::SourceIsFromCacheAttribute).toBool()) {
+            QExecutionStatistics::increment("disk-cache-hits");
+        } else {
+            QExecutionStatistics::increment("disk-cache-misses");
+        }
+    }
+
+    // Any change of a cached local file invalidates the WebKit memory cache,
+    // so that no stale application files are ever displayed:
+    void qAssetChangedSlot(QString path)
     {
-        pageStatus = pageStatusTransmitted;
+        QWebSettings::clearMemoryCaches();
+        QExecutionStatistics::increment("object-cache-invalidations");
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "local file changed, object cache cleared:" << path;
+    }
+
+public:
+    static QAccessManager *qSharedAccessManager();
+
+    // Returns the page of the frame from where a request originated or
+    // 0 for requests not originating from a frame:
+    static QWebPage *qOriginatingPage(const QNetworkRequest &request)
+    {
+        QWebFrame *frame =
+                qobject_cast<QWebFrame *>(request.originatingObject());
+
+        if (frame == 0) {
+            return 0;
+        }
+
+        return frame->page();
     }
 
 private:
     QString emptyString;
     QRegExp scriptAjaxMarker;
-    QStringList trustedDomains;
-    QString pageStatus;
+    QHash<QObject *, QPageStatus> pageStatuses;
+
+    static QAccessManager *sharedAccessManager;
 };
 
 // ==============================
@@ -520,32 +1758,138 @@ class QPage : public QWebPage
 {
     Q_OBJECT
 
-signals:
-    void changeTitleSignal();
-    void displayScriptErrorsSignal(QString errors);
-    void printPreviewSignal();
-    void printSignal();
-    void selectInodeSignal(QNetworkRequest request);
-    void pageStatusSignal(QString pageStatus);
-    void closeInteractiveScriptSignal();
-    void closeWindowSignal();
+signals:
+    void changeTitleSignal();
+    void displayScriptErrorsSignal(QString errors);
+    void printPreviewSignal();
+    void printSignal();
+    void selectInodeSignal(QNetworkRequest request);
+    void pageStatusSignal(QPageStatus pageStatus);
+    void closeInteractiveScriptSignal();
+    void closeWindowSignal();
+
+public slots:
+    void qPageLoadedSlot(bool ok)
+    {
+        if (ok) {
+            emit changeTitleSignal();
+
+#if PAGE_CACHE_PAGES > 0
+            qPageCacheCheck();
+#endif
+
+#if PREFETCH_BUDGET > 0
+            qPrefetchCheck();
+#endif
+        }
+    }
+
+    void qPageLoadStartedSlot()
+    {
+#if PREFETCH_BUDGET > 0
+        // Prefetching is cancelled on navigation:
+        QPrefetchEngine::qSharedEngine()->qCancel(this);
+#endif
+    }
+
+    // ==============================
+    // PREFETCH:
+    // ==============================
+    // Local targets linked from trusted pages are read in advance.
+    // AJAX GET scripts are run in advance only if
+    // their elements are marked as prefetchable using:
+    // data-peb-prefetch or data-peb-prefetch='/ajax-script.pl'
+    // Stylesheets, scripts and images of this page are not looked for,
+    // because they are already loaded when the page load is finished -
+    // those of prefetched pages are prefetched by the engine.
+    void qPrefetchCheck()
+    {
+        if (pageStatus != PageStatusTrusted) {
+            QPrefetchEngine::qSharedEngine()->qDiscard(this);
+            return;
+        }
+
+        QList<QUrl> prefetchUrls;
+        QSet<QString> markedUrls;
+
+        QWebElementCollection prefetchElements =
+                mainFrame()->findAllElements(
+                    "a[href], link[rel=prefetch], link[rel=next], "
+                    "[data-peb-prefetch]");
+
+        foreach (QWebElement prefetchElement, prefetchElements) {
+            QString target = prefetchElement.attribute("data-peb-prefetch");
+            if (target.length() == 0) {
+                target = prefetchElement.hasAttribute("href") ?
+                            prefetchElement.attribute("href") :
+                            prefetchElement.attribute("src");
+            }
+
+            if (target.length() == 0) {
+                continue;
+            }
+
+            QUrl url = mainFrame()->baseUrl().resolved(QUrl(target));
+            url.setFragment(QString());
 
-public slots:
-    void qPageLoadedSlot(bool ok)
+            prefetchUrls.append(url);
+            if (prefetchElement.hasAttribute("data-peb-prefetch")) {
+                markedUrls.insert(url.toString());
+            }
+        }
+
+        QPrefetchEngine::qSharedEngine()->qStart(
+                    this, prefetchUrls, markedUrls);
+    }
+
+    // ==============================
+    // PAGE CACHE:
+    // ==============================
+    // Only trusted pages are cached for back and forward navigation.
+    // A page or script output can also opt out using:
+    // <meta name='peb-cache' content='no-cache'>
+    // WebKit never caches pages with unload handlers, so
+    // an empty unload handler is added to all pages, which are not cached.
+    void qPageCacheCheck()
     {
-        if (ok) {
-            emit changeTitleSignal();
+        QWebElement cacheElement =
+                mainFrame()->findFirstElement("meta[name=peb-cache]");
+
+        if (pageStatus != PageStatusTrusted or
+                cacheElement.attribute("content") == "no-cache") {
+            mainFrame()->evaluateJavaScript(
+                        "window.addEventListener"
+                        "('unload', function () {}); null");
+            return;
         }
+
+        QPageCacheBudget::recordPage(
+                    totalBytes() +
+                    mainFrame()->toHtml().size() * sizeof(QChar));
     }
 
     // ==============================
     // STARTING SCRIPTS:
     // ==============================
-    void qStartScriptSlot(QUrl url, QByteArray postDataArray)
+    void qStartScriptSlot(QWebPage *page, QUrl url, QByteArray postDataArray)
     {
+        // Only scripts requested from this page are started here:
+        if (page != this) {
+            return;
+        }
+
+        // Scripts of a packed application wait for its extraction and
+        // are started again when the extraction is finished:
+        if (!QApplicationArchive::qWhenExtracted(
+                    this, SLOT(qArchiveExtractedSlot()))) {
+            extractionWaitingScripts.append(
+                        QPair<QUrl, QByteArray>(url, postDataArray));
+            QExecutionStatistics::enqueued("archive-extraction-scripts");
+            return;
+        }
+
         QString scriptFullFilePath = QDir::toNativeSeparators
-                ((qApp->property("application").toString()) +
-                 url.path());
+                (QApplicationArchive::qScriptsDirectory() + url.path());
 
         QUrlQuery scriptQuery(url);
         QString scriptType = scriptQuery.queryItemValue("type");
@@ -590,6 +1934,9 @@ public slots:
                             << interactiveScriptFullFilePath,
                             QProcess::Unbuffered | QProcess::ReadWrite);
 
+                QExecutionStatistics::increment(
+                            "interactive-script-launches");
+
                 qDebug() << "Interactive script"
                          << interactiveScriptFullFilePath
                          << "started.";
@@ -611,9 +1958,53 @@ public slots:
 
         // Start noninteractive script:
         if (scriptFullFilePath != interactiveScriptFullFilePath) {
+#if PERL_PROFILER_INTERACTION == 1
+            // The first profiled script waits for the profiler check and
+            // is started again when the check is finished:
+            if (scriptQuery.queryItemValue("profile") == "nytprof" and
+                    !QProfilerCheck::qSharedCheck()->qIsFinished()) {
+                profiledScriptsQueue.append(
+                            QPair<QUrl, QByteArray>(url, postDataArray));
+                QExecutionStatistics::enqueued("profiled-scripts");
+
+                QObject::connect(QProfilerCheck::qSharedCheck(),
+                                 SIGNAL(checkFinishedSignal()),
+                                 this,
+                                 SLOT(qProfilerCheckedSlot()),
+                                 Qt::UniqueConnection);
+                QProfilerCheck::qSharedCheck()->qStart();
+                return;
+            }
+
+            // Profiling is skipped if Devel::NYTProf is not installed:
+            if (scriptQuery.queryItemValue("profile") == "nytprof" and
+                    !QProfilerCheck::qSharedCheck()->qIsAvailable()) {
+                QString errorMessage =
+                        "<p>Profiling is not possible, because "
+                        "Devel::NYTProf is not installed for<br>" +
+                        qApp->property("perlInterpreter").toString() +
+                        "<br>Script was not started:<br>" +
+                        scriptFullFilePath + "</p>";
+                qDebug() << "Devel::NYTProf is not installed,"
+                         << "script was not started:"
+                         << scriptFullFilePath;
+
+                QPage::currentFrame()->setHtml(
+                            QPageTemplate::qErrorPage(errorMessage));
+                return;
+            }
+#endif
+
             QNonInteractiveScriptHandler *nonInteractiveScriptHandler =
                     new QNonInteractiveScriptHandler(url, postDataArray);
 
+#if PERL_PROFILER_INTERACTION == 1
+            QObject::connect(nonInteractiveScriptHandler,
+                             SIGNAL(scriptProfiledSignal(QString)),
+                             this,
+                             SLOT(qStartProfileReportSlot(QString)));
+#endif
+
             // Signals and slots for all local noninteractive scripts:
             QObject::connect(nonInteractiveScriptHandler,
                              SIGNAL(displayScriptOutputSignal(QString,
@@ -625,13 +2016,86 @@ public slots:
                              SIGNAL(scriptFinishedSignal(QString,
                                                          QString,
                                                          QString,
-                                                         QString)),
+                                                         QString,
+                                                         bool)),
                              this,
                              SLOT(qScriptFinishedSlot(QString,
                                                       QString,
                                                       QString,
-                                                      QString)));
+                                                      QString,
+                                                      bool)));
+        }
+    }
+
+    // ==============================
+    // PROFILE REPORTS:
+    // ==============================
+    void qStartProfileReportSlot(QString profileDirectory)
+    {
+#if PERL_PROFILER_INTERACTION == 1
+        QProfileReportHandler *profileReportHandler =
+                new QProfileReportHandler(profileDirectory);
+
+        QObject::connect(profileReportHandler,
+                         SIGNAL(reportReadySignal(QString)),
+                         this,
+                         SLOT(qDisplayProfileReportSlot(QString)));
+#else
+        Q_UNUSED(profileDirectory);
+#endif
+    }
+
+    void qArchiveExtractedSlot()
+    {
+        QList<QPair<QUrl, QByteArray> > waitingScripts =
+                extractionWaitingScripts;
+        extractionWaitingScripts.clear();
+        QExecutionStatistics::dequeued("archive-extraction-scripts",
+                                       waitingScripts.length());
+
+        for (int index = 0; index < waitingScripts.length(); index++) {
+            qStartScriptSlot(this,
+                             waitingScripts.at(index).first,
+                             waitingScripts.at(index).second);
+        }
+    }
+
+    void qProfilerCheckedSlot()
+    {
+#if PERL_PROFILER_INTERACTION == 1
+        QList<QPair<QUrl, QByteArray> > profiledScripts =
+                profiledScriptsQueue;
+        profiledScriptsQueue.clear();
+        QExecutionStatistics::dequeued("profiled-scripts",
+                                       profiledScripts.length());
+
+        for (int index = 0; index < profiledScripts.length(); index++) {
+            qStartScriptSlot(this,
+                             profiledScripts.at(index).first,
+                             profiledScripts.at(index).second);
+        }
+#endif
+    }
+
+    void qDisplayProfileReportSlot(QString reportIndexFilePath)
+    {
+#if PERL_PROFILER_INTERACTION == 1
+        // The report is a trusted page of the browser pseudodomain and
+        // not an untrusted local file:
+        QPage *page = qobject_cast<QPage *>(
+                    QPage::createWindow(QWebPage::WebBrowserWindow));
+        if (page == 0) {
+            qDebug() << "No window for profile report:"
+                     << reportIndexFilePath;
+            return;
         }
+
+        page->qSetTrusted();
+        page->mainFrame()->load(
+                    QProfileReportHandler::qReportUrl(reportIndexFilePath));
+#else
+        Q_UNUSED(reportIndexFilePath);
+#endif
     }
 
     // ==============================
@@ -724,9 +2188,15 @@ public slots:
     void qScriptFinishedSlot(QString scriptAccumulatedOutput,
                              QString scriptAccumulatedErrors,
                              QString scriptFullFilePath,
-                             QString scriptOutputTarget)
+                             QString scriptOutputTarget,
+                             bool scriptTerminated)
     {
-        if (pageStatus == "untrusted") {
+        // Every noninteractive script handler is used only once:
+        if (sender() != 0) {
+            sender()->deleteLater();
+        }
+
+        if (pageStatus == PageStatusUntrusted) {
             QString errorMessage =
                     "<p>Displaying output from local Perl scripts after "
                     "untrusted content is loaded in the same window "
@@ -740,17 +2210,13 @@ public slots:
                      << QPage::currentFrame()->
                         baseUrl().toString();
 
-            QFileReader *resourceReader =
-                    new QFileReader(QString(":/html/error.html"));
-            QString htmlErrorContents = resourceReader->fileContents;
-
-            htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
-            QPage::currentFrame()->setHtml(htmlErrorContents);
+            QPage::currentFrame()->setHtml(
+                        QPageTemplate::qErrorPage(errorMessage));
 
             qDebug() << errorMessage;
         }
 
-        if (pageStatus == "trusted") {
+        if (pageStatus == PageStatusTrusted) {
             // If noninteractive script has no errors and
             // no target DOM element:
             if (scriptAccumulatedOutput.length() > 0 and
@@ -770,6 +2236,7 @@ public slots:
                         // in the same window:
                         qFormatScriptErrors(scriptAccumulatedErrors,
                                             scriptFullFilePath,
+                                            scriptTerminated,
                                             false);
                     } else {
                         // If noninteractive script has no output and
@@ -779,6 +2246,7 @@ public slots:
                         // in a new window:
                         qFormatScriptErrors(scriptAccumulatedErrors,
                                             scriptFullFilePath,
+                                            scriptTerminated,
                                             true);
                     }
                 } else {
@@ -786,6 +2254,7 @@ public slots:
                     // HTML formatted errors will be displayed in a new window:
                     qFormatScriptErrors(scriptAccumulatedErrors,
                                         scriptFullFilePath,
+                                        scriptTerminated,
                                         true);
                     qDisplayScriptOutputSlot(scriptAccumulatedOutput,
                                              emptyString);
@@ -796,11 +2265,14 @@ public slots:
 
     void qFormatScriptErrors(QString errors,
                              QString scriptFullFilePath,
+                             bool scriptTerminated,
                              bool newWindow)
     {
         QString scriptErrorTitle;
         if (errors.contains("trapped")) {
             scriptErrorTitle = "Insecure code was blocked:";
+        } else if (scriptTerminated == true) {
+            scriptErrorTitle = "Script was terminated:";
         } else {
             scriptErrorTitle = "Errors were found during script execution:";
         }
@@ -815,11 +2287,8 @@ public slots:
                 errors +
                 "</pre>";
 
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/html/error.html"));
-        QString scriptFormattedErrors = resourceReader->fileContents;
-
-        scriptFormattedErrors.replace("ERROR_MESSAGE", scriptError);
+        QString scriptFormattedErrors =
+                QPageTemplate::qErrorPage(scriptError);
 
         if (newWindow == false) {
             qDisplayScriptOutputSlot(scriptFormattedErrors, emptyString);
@@ -835,6 +2304,10 @@ public slots:
     // ==============================
     void qSslErrorsSlot(QNetworkReply *reply, const QList<QSslError> &errors)
     {
+        if (QAccessManager::qOriginatingPage(reply->request()) != this) {
+            return;
+        }
+
         reply->ignoreSslErrors();
 
         foreach (QSslError error, errors) {
@@ -844,8 +2317,10 @@ public slots:
 
     void qNetworkReply(QNetworkReply *reply)
     {
-        QStringList trustedDomains =
-                qApp->property("trustedDomains").toStringList();
+        // The shared access manager reports the replies of all pages:
+        if (QAccessManager::qOriginatingPage(reply->request()) != this) {
+            return;
+        }
 
         if (reply->error() != QNetworkReply::NoError) {
             qDebug() << "Network error:" << reply->errorString();
@@ -853,37 +2328,32 @@ public slots:
             if (reply->url().fileName().length() == 0 or
                     reply->url().fileName()
                     .contains(htmlFileNameExtensionMarker)) {
-                QFileReader *resourceReader =
-                        new QFileReader(QString(":/html/error.html"));
-                QString htmlErrorContents = resourceReader->fileContents;
-
-                htmlErrorContents
-                        .replace("ERROR_MESSAGE",
-                                 "<p>" + reply->errorString() + "</p>");
-                QPage::currentFrame()->setHtml(htmlErrorContents);
+                QPage::currentFrame()->setHtml(
+                            QPageTemplate::qErrorPage(
+                                "<p>" + reply->errorString() + "</p>"));
             }
         }
 
         if (reply->error() == QNetworkReply::NoError) {
             if (reply->url() == qApp->property("startPage").toString()) {
-                pageStatus = "trusted";
+                pageStatus = PageStatusTrusted;
                 emit pageStatusSignal(pageStatus);
             }
 
-            if (pageStatus.length() == 0) {
-                if (trustedDomains.contains(reply->url().authority())) {
-                    pageStatus = "trusted";
-                    emit pageStatusSignal(pageStatus);
+            if (pageStatus == PageStatusUnknown) {
+                if (QTrustedDomains::contains(
+                            reply->url().host().toLower())) {
+                    pageStatus = PageStatusTrusted;
+                } else {
+                    pageStatus = PageStatusUntrusted;
                 }
 
-                if (!trustedDomains.contains(reply->url().authority())) {
-                    pageStatus = "untrusted";
-                    emit pageStatusSignal(pageStatus);
-                }
+                emit pageStatusSignal(pageStatus);
             }
 
-            if (pageStatus == "trusted") {
-                if (!trustedDomains.contains(reply->url().authority())) {
+            if (pageStatus == PageStatusTrusted) {
+                if (!QTrustedDomains::contains(
+                            reply->url().host().toLower())) {
                     qMixedContentWarning(reply->url());
                 }
             }
@@ -904,12 +2374,7 @@ public slots:
         qDebug() << "Mixed content is detected. Offending URL:"
                  << url.toString();
 
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/html/error.html"));
-        QString htmlErrorContents = resourceReader->fileContents;
-
-        htmlErrorContents.replace("ERROR_MESSAGE", errorMessage);
-        QPage::mainFrame()->setHtml(htmlErrorContents);
+        QPage::mainFrame()->setHtml(QPageTemplate::qErrorPage(errorMessage));
     }
 
     // ==============================
@@ -917,11 +2382,8 @@ public slots:
     // ==============================
     void qJavaScriptInjector(QWebFrame *frame)
     {
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/scripts/peb.js"));
-        QString pebJavaScript = resourceReader->fileContents;
-
-        frame->evaluateJavaScript(pebJavaScript);
+        QFileReader resourceReader(QString(":/scripts/peb.js"));
+        frame->evaluateJavaScript(resourceReader.fileContents);
     }
 
     // ==============================
@@ -1005,9 +2467,11 @@ public slots:
         }
     }
 
-    void qCloseWindowTransmitterSlot()
+    void qCloseWindowTransmitterSlot(QWebPage *page)
     {
-        emit closeWindowSignal();
+        if (page == this) {
+            emit closeWindowSignal();
+        }
     }
 
     // ==============================
@@ -1018,26 +2482,68 @@ public slots:
     {
 #if PERL_DEBUGGER_INTERACTION == 1
         // Clean any previous debugger output:
-        debuggerAccumulatedOutput = "";
+        debuggerPromptsReceived = 0;
+        debuggerPendingOutput = "";
+        debuggerCurrentOutput = "";
+        debuggerDisplayedOutputLength = 0;
+        debuggerEmptyOutputLines = 0;
+        debuggerCurrentFile = "";
+        debuggerCurrentLine = 0;
 
         QString commandLineArguments;
 
         if (debuggerHandler.isOpen()) {
-            QByteArray debuggerCommand;
-            debuggerCommand.append(debuggerLastCommand.toLatin1());
-            debuggerCommand.append(QString("\n").toLatin1());
-            debuggerHandler.write(debuggerCommand);
+            qDebuggerSendCommand();
         } else {
             debuggerJustStarted = true;
+            debuggerPromptScanner.reset();
+
+            // The debugger connects back to a local socket, so that
+            // it does not depend on any terminal:
+            if (!debuggerServer.isListening() and
+                    !debuggerServer.listen(QHostAddress::LocalHost, 0)) {
+                QString errorMessage =
+                        "<p>Perl debugger can not be started, because "
+                        "no local socket is available:<br>" +
+                        debuggerServer.errorString() + "</p>";
+                qDebug() << "Perl debugger server can not listen:"
+                         << debuggerServer.errorString();
+
+                debuggerPendingCommand.clear();
+                QPage::currentFrame()->setHtml(
+                            QPageTemplate::qErrorPage(errorMessage));
+                return;
+            }
+
+            // Any local process can connect to the socket, so
+            // the debugger has to send a new token of this session
+            // as soon as it is loaded and before any command is sent:
+            debuggerToken = QUuid::createUuid().toRfc4122().toHex();
 
             // Sеt the environment for the debugged script:
             QProcessEnvironment systemEnvironment =
                     QProcessEnvironment::systemEnvironment();
-            systemEnvironment.insert("PERLDB_OPTS", "ReadLine=0");
+            systemEnvironment.insert("PERLDB_OPTS",
+                                     "ReadLine=0 RemotePort=127.0.0.1:"
+                                     + QString::number(
+                                         debuggerServer.serverPort()));
+            systemEnvironment.insert("PERL5DB",
+                                     "BEGIN { require 'perl5db.pl'; "
+                                     "print {$DB::OUT} \"" +
+                                     QString::fromLatin1(debuggerToken) +
+                                     "\\n\"; }");
             debuggerHandler.setProcessEnvironment(systemEnvironment);
 
-            if (!debuggerScriptToDebug.contains(
-                        qApp->property("application").toString())) {
+            delete debuggerScriptDecoder;
+            debuggerScriptDecoder =
+                    QTextCodec::codecForName("UTF-8")->makeDecoder();
+
+            // Only scripts inside the scripts directory are started
+            // without asking for command line arguments:
+            if (!QDir::toNativeSeparators(debuggerScriptToDebug).startsWith(
+                        QDir::toNativeSeparators(
+                            QApplicationArchive::qScriptsDirectory())
+                        + QDir::separator())) {
                 bool ok;
                 QString input =
                         QInputDialog::getText(
@@ -1067,10 +2573,107 @@ public slots:
                                   QProcess::Unbuffered
                                   | QProcess::ReadWrite);
 
-            QByteArray debuggerCommand;
-            debuggerCommand.append(debuggerLastCommand.toLatin1());
-            debuggerCommand.append(QString("\n").toLatin1());
-            debuggerHandler.write(debuggerCommand);
+            // The first command is sent when the debugger connects:
+            if (debuggerLastCommand.length() > 0) {
+                qDebuggerSendCommand();
+            }
+        }
+#endif
+    }
+
+    void qDebuggerSendCommand()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // Every command is a single line:
+        QByteArray debuggerCommand;
+        debuggerCommand.append(debuggerLastCommand.toLatin1());
+        debuggerCommand.append(QString("\n").toLatin1());
+
+        if (debuggerSocket == 0 or
+                debuggerSocket->state() != QAbstractSocket::ConnectedState) {
+            debuggerPendingCommand = debuggerCommand;
+            return;
+        }
+
+        debuggerSocket->write(debuggerCommand);
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: command sent to Perl debugger:"
+                 << debuggerLastCommand;
+#endif
+    }
+
+    void qDebuggerConnectedSlot()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // Every peer is accepted only after it sends the token:
+        while (debuggerServer.hasPendingConnections()) {
+            QTcpSocket *peerSocket = debuggerServer.nextPendingConnection();
+            debuggerHandshakes.insert(peerSocket, QByteArray());
+
+            QObject::connect(peerSocket, SIGNAL(readyRead()),
+                             this, SLOT(qDebuggerHandshakeSlot()));
+            QObject::connect(peerSocket, SIGNAL(disconnected()),
+                             this, SLOT(qDebuggerPeerDisconnectedSlot()));
+        }
+#endif
+    }
+
+    void qDebuggerHandshakeSlot()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        QTcpSocket *peerSocket = qobject_cast<QTcpSocket *>(sender());
+        if (peerSocket == 0 or !debuggerHandshakes.contains(peerSocket)) {
+            return;
+        }
+
+        debuggerHandshakes[peerSocket].append(peerSocket->readAll());
+        QByteArray handshake = debuggerHandshakes.value(peerSocket);
+
+        // The loading banner of the debugger is printed before the token:
+        int tokenStart = handshake.indexOf("\n" + debuggerToken + "\n");
+        if (debuggerToken.length() == 0 or tokenStart < 0) {
+            if (handshake.size() > 4096) {
+                qDebug() << QDateTime::currentMSecsSinceEpoch()
+                         << "msecs from epoch:"
+                         << "unexpected peer of the Perl debugger refused.";
+
+                debuggerHandshakes.remove(peerSocket);
+                peerSocket->disconnect(this);
+                peerSocket->abort();
+                peerSocket->deleteLater();
+            }
+            return;
+        }
+
+        debuggerHandshakes.remove(peerSocket);
+        peerSocket->disconnect(this);
+
+        // The debugger connects again after every restart,
+        // the previous connection is not used anymore:
+        if (debuggerSocket != 0) {
+            debuggerSocket->disconnect(this);
+            debuggerSocket->deleteLater();
+        }
+
+        debuggerSocket = peerSocket;
+
+        QObject::connect(debuggerSocket, SIGNAL(readyRead()),
+                         this, SLOT(qDebuggerOutputSlot()));
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: Perl debugger connected.";
+
+        delete debuggerDecoder;
+        debuggerDecoder = QTextCodec::codecForName("UTF-8")->makeDecoder();
+
+        qDebuggerReceiveOutput(
+                    handshake.left(tokenStart + 1) +
+                    handshake.mid(tokenStart + debuggerToken.length() + 2));
+
+        if (debuggerPendingCommand.length() > 0) {
+            debuggerSocket->write(debuggerPendingCommand);
+            debuggerPendingCommand.clear();
 
             qDebug() << QDateTime::currentMSecsSinceEpoch()
                      << "msecs from epoch: command sent to Perl debugger:"
@@ -1079,15 +2682,68 @@ public slots:
 #endif
     }
 
+    void qDebuggerPeerDisconnectedSlot()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        QTcpSocket *peerSocket = qobject_cast<QTcpSocket *>(sender());
+        if (peerSocket != 0 and debuggerHandshakes.contains(peerSocket)) {
+            debuggerHandshakes.remove(peerSocket);
+            peerSocket->deleteLater();
+        }
+#endif
+    }
+
+    void qDebuggerScriptOutputSlot()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // Output of the debugged script is displayed together with
+        // the output of the debugger:
+        QString scriptOutput = debuggerScriptDecoder->toUnicode(
+                    debuggerHandler.readAllStandardOutput());
+        qDebuggerFormatOutput(scriptOutput);
+        qDebuggerDisplayOutput();
+#endif
+    }
+
+    void qDebuggerFinishedSlot()
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        if (debuggerSocket != 0) {
+            debuggerSocket->disconnect(this);
+            debuggerSocket->deleteLater();
+            debuggerSocket = 0;
+        }
+
+        foreach (QTcpSocket *peerSocket, debuggerHandshakes.keys()) {
+            peerSocket->disconnect(this);
+            peerSocket->abort();
+            peerSocket->deleteLater();
+        }
+        debuggerHandshakes.clear();
+
+        debuggerServer.close();
+        debuggerPendingCommand.clear();
+        debuggerToken.clear();
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: Perl debugger finished.";
+#endif
+    }
+
     void qDebuggerOutputSlot()
     {
 #if PERL_DEBUGGER_INTERACTION == 1
-        // Read debugger output:
-        QString debuggerOutput = debuggerHandler.readAllStandardOutput();
+        qDebuggerReceiveOutput(debuggerSocket->readAll());
+#endif
+    }
 
-        // Append last output of the debugger to
-        // the accumulated debugger output:
-        debuggerAccumulatedOutput.append(debuggerOutput);
+    void qDebuggerReceiveOutput(QByteArray debuggerOutputArray)
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // Multibyte characters split between two reads are
+        // decoded only when all of their bytes are received:
+        QString debuggerOutput =
+                debuggerDecoder->toUnicode(debuggerOutputArray);
 
         // qDebug() << QDateTime::currentMSecsSinceEpoch()
         //          << "msecs from epoch:"
@@ -1095,127 +2751,274 @@ public slots:
         // qDebug() << "Debugger raw output:" << endl
         //          << debuggerOutput;
 
-        // Formatting of Perl debugger output is started only after
-        // the final command prompt comes out of the debugger:
-        if (debuggerJustStarted == true) {
-            if (debuggerLastCommand.length() > 0 and
-                    debuggerAccumulatedOutput.contains(
-                        QRegExp ("DB\\<\\d{1,5}\\>.*DB\\<\\d{1,5}\\>"))) {
+        // Debugger output is split into segments at every command prompt and
+        // is formatted and displayed as soon as it arrives:
+        int segmentStart = 0;
+        foreach (int promptEnd, debuggerPromptScanner.scan(debuggerOutput)) {
+            qDebuggerFormatOutput(
+                        debuggerOutput.mid(segmentStart,
+                                           promptEnd - segmentStart));
+            qDebuggerFinishOutputSegment();
+            segmentStart = promptEnd;
+
+            // When the debugger is just started with a command,
+            // the view is completed only after the second command prompt:
+            debuggerPromptsReceived++;
+            if (debuggerJustStarted == false or
+                    debuggerLastCommand.length() == 0 or
+                    debuggerPromptsReceived > 1) {
                 debuggerJustStarted = false;
+                debuggerPromptsReceived = 0;
 
-                if (debuggerOutputHandler.isOpen()) {
-                    debuggerOutputHandler.close();
-                }
-                qDebuggerStartHtmlFormatter();
+                qDebuggerRefreshView();
             }
+        }
 
-            if (debuggerLastCommand.length() == 0 and
-                    debuggerAccumulatedOutput
-                    .contains(QRegExp ("DB\\<\\d{1,5}\\>"))) {
-                debuggerJustStarted = false;
+        qDebuggerFormatOutput(debuggerOutput.mid(segmentStart));
+        qDebuggerDisplayOutput();
+#endif
+    }
 
-                if (debuggerOutputHandler.isOpen()) {
-                    debuggerOutputHandler.close();
-                }
+    void qDebuggerFormatOutput(QString debuggerOutput)
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // Only complete lines are formatted,
+        // the last incomplete line waits for the rest of its output:
+        debuggerPendingOutput.append(debuggerOutput);
+
+        int lineStart = 0;
+        int lineEnd = debuggerPendingOutput.indexOf("\n");
+        while (lineEnd >= 0) {
+            qDebuggerFormatOutputLine(
+                        debuggerPendingOutput.mid(lineStart,
+                                                  lineEnd - lineStart));
+            lineStart = lineEnd + 1;
+            lineEnd = debuggerPendingOutput.indexOf("\n", lineStart);
+        }
+
+        debuggerPendingOutput.remove(0, lineStart);
+#endif
+    }
+
+    void qDebuggerFormatOutputLine(QString debuggerOutputLine)
+    {
+#if PERL_DEBUGGER_INTERACTION == 1
+        // The last file and line information in the debugger output
+        // is used for the highlighted source:
+        if (debuggerOutputLine.contains(
+                    QRegExp("[\\(\\[].*\\:{1,1}\\d{1,5}[\\)\\]]"))) {
+            QString lineInfo = debuggerOutputLine;
+            lineInfo.replace(QRegExp("^.*[\\(\\[]"), "");
+            lineInfo.replace(QRegExp("[\\)\\]].*"), "");
+
+            // Split-based solution is not used here,
+            // because Windows filepaths also contain colons:
+            debuggerCurrentFile = lineInfo;
+            debuggerCurrentFile.replace(QRegExp("\\:\\d{1,}$"), "");
+            debuggerCurrentLine =
+                    lineInfo.replace(QRegExp("^.*\\:"), "").toInt();
+        }
+
+        // Editor support is not available within the Perl debugger GUI:
+        if (debuggerOutputLine.contains(
+                    QRegExp("^Editor support available.\\r?$"))) {
+            return;
+        }
 
-                qDebuggerStartHtmlFormatter();
+        // Remove debugger command prompt:
+        if (debuggerOutputLine.contains(
+                    QRegExp("\\s{1,}DB\\<{1,}\\d{1,5}\\>{1,}\\s?"))) {
+            debuggerOutputLine.replace(
+                        QRegExp("\\s{1,}DB\\<{1,}\\d{1,5}\\>{1,}\\s?"), "");
+
+            if (debuggerOutputLine.trimmed().length() == 0) {
+                return;
             }
         }
 
-        if (debuggerJustStarted == false and
-                debuggerAccumulatedOutput
-                .contains(QRegExp ("DB\\<\\d{1,5}\\>"))) {
-            if (debuggerOutputHandler.isOpen()) {
-                debuggerOutputHandler.close();
+        // Two or more empty lines are displayed as a single empty line:
+        if (debuggerOutputLine.trimmed().length() == 0) {
+            debuggerEmptyOutputLines++;
+            if (debuggerEmptyOutputLines > 1) {
+                return;
             }
-            qDebuggerStartHtmlFormatter();
+        } else {
+            debuggerEmptyOutputLines = 0;
         }
+
+        // Purely aesthetic replacement:
+        debuggerOutputLine.replace("`", "'");
+
+        // Escape any HTML so that any HTML output from
+        // the debugger is not rendered;
+        // sequence of replacements is important here:
+        debuggerOutputLine.replace("&", "&amp;");
+        debuggerOutputLine.replace("<", "&lt;");
+        debuggerOutputLine.replace(">", "&gt;");
+        // Replace any tabs with spaces:
+        debuggerOutputLine.replace("\t", " ");
+        // Replace two spaces with two HTML whitespace entities:
+        debuggerOutputLine.replace("  ", "&nbsp;&nbsp;");
+
+        debuggerCurrentOutput.append(debuggerOutputLine + "<br>\n");
 #endif
     }
 
-    void qDebuggerStartHtmlFormatter()
+    void qDebuggerFinishOutputSegment()
     {
 #if PERL_DEBUGGER_INTERACTION == 1
-        // 'dbgformatter.pl' is compiled into the resources of
-        // the binary file and is read from there.
-        QFileReader *resourceReader = new QFileReader(
-                    QString(":/scripts/dbgformatter.pl"));
-        QString debuggerOutputFormatterScript = resourceReader->fileContents;
-
-        // Set clean environment:
-        QProcessEnvironment cleanEnvironment;
-        cleanEnvironment.insert("REQUEST_METHOD", "GET");
-        cleanEnvironment.insert("QUERY_STRING", debuggerAccumulatedOutput);
-        debuggerOutputHandler.setProcessEnvironment(cleanEnvironment);
-
-        // Clean any previous debugger output:
-        debuggerAccumulatedOutput = "";
-
-        // Set path to the syntax highlighting module:
-        debuggerOutputFormatterScript.replace("PEBLIB_PATH",
-                         QApplication::applicationDirPath()
-                         + QDir::separator() + "sdk"
-                         + QDir::separator() + "peblib");
-
-        // Start the Perl debugger output formatting script:
-        debuggerOutputHandler
-                .start((qApp->property("perlInterpreter").toString()),
-                       QStringList()
-                       << "-e"
-                       << debuggerOutputFormatterScript
-                       << debuggerScriptToDebug,
-                       QProcess::Unbuffered | QProcess::ReadWrite);
-
-        qDebug() << QDateTime::currentMSecsSinceEpoch()
-                 << "msecs from epoch:"
-                 << "Perl debugger output formatter script started.";
+        // The last incomplete line is the debugger command prompt:
+        qDebuggerFormatOutputLine(debuggerPendingOutput);
+        debuggerPendingOutput = "";
 #endif
     }
 
-    void qDebuggerHtmlFormatterOutputSlot()
+    void qDebuggerDisplayOutput()
     {
 #if PERL_DEBUGGER_INTERACTION == 1
-        QString debuggerHtmlOutput =
-                debuggerOutputHandler.readAllStandardOutput();
+        if (debuggerViewLoading == true) {
+            return;
+        }
 
-        // Append last output of the debugger formatter to
-        // the accumulated debugger formatter output:
-        debuggerAccumulatedHtmlOutput.append(debuggerHtmlOutput);
+        QWebElement debuggerOutputElement =
+                debuggerFrame->findFirstElement("#debugger-output");
 
-        qDebug() << QDateTime::currentMSecsSinceEpoch()
-                 << "msecs from epoch:"
-                 << "output from Perl debugger formatter received.";
+        if (debuggerOutputElement.isNull()) {
+            return;
+        }
+
+        // Only output, which is not displayed yet, is added to the view:
+        if (debuggerDisplayedOutputLength == 0) {
+            debuggerOutputElement.setInnerXml(debuggerCurrentOutput);
+        } else if (debuggerCurrentOutput.length() >
+                   debuggerDisplayedOutputLength) {
+            debuggerOutputElement.appendInside(
+                        debuggerCurrentOutput
+                        .mid(debuggerDisplayedOutputLength));
+        }
+
+        debuggerDisplayedOutputLength = debuggerCurrentOutput.length();
 #endif
     }
 
-    void qDebuggerHtmlFormatterErrorsSlot()
+    void qDebuggerRefreshView()
     {
 #if PERL_DEBUGGER_INTERACTION == 1
-        QString debuggerOutputFormatterErrors =
-                debuggerOutputHandler.readAllStandardError();
+        if (debuggerViewLoading == true) {
+            return;
+        }
+
+        // The debugger view is rendered only once per debugging session and
+        // is updated later without reloading:
+        QWebElement debuggerOutputElement =
+                debuggerFrame->findFirstElement("#debugger-output");
+
+        if (debuggerOutputElement.isNull()) {
+            QString debuggerHtml =
+                    QPageTemplate::qRender(
+                        ":/html/debugger.html", "SCRIPT_TO_DEBUG",
+                        debuggerScriptToDebug.toHtmlEscaped());
+
+            debuggerDisplayedOutputLength = 0;
+            debuggerDisplayedFile = "";
+            debuggerViewLoading = true;
+
+            QObject::connect(debuggerFrame, SIGNAL(loadFinished(bool)),
+                             this, SLOT(qDebuggerViewLoadedSlot(bool)),
+                             Qt::UniqueConnection);
+
+            debuggerFrame->setHtml(debuggerHtml, QUrl(PSEUDO_DOMAIN));
+
+            qDebug() << QDateTime::currentMSecsSinceEpoch()
+                     << "msecs from epoch:"
+                     << "Perl debugger view rendered.";
+            return;
+        }
+
+        qDebuggerDisplayOutput();
+
+        if (debuggerCurrentFile.length() == 0) {
+            debuggerFrame->evaluateJavaScript("pebDebuggerHideSource();");
+            return;
+        }
+
+        // Highlighted source is replaced only when
+        // another file is debugged or the debugged file is modified:
+        QFileInfo currentFileInfo(debuggerCurrentFile);
+        if (debuggerCurrentFile != debuggerDisplayedFile or
+                currentFileInfo.lastModified() !=
+                debuggerDisplayedFileLastModified) {
+            QString highlightedSource;
+            if (!QHighlightedSourceCache::find(debuggerCurrentFile,
+                                               highlightedSource)) {
+                // The modification time is taken before reading, so that
+                // any later modification invalidates the cached source:
+                QDateTime lastModified = currentFileInfo.lastModified();
+
+                QFileReader sourceReader(debuggerCurrentFile);
+                QPerlSyntaxHighlighter sourceHighlighter(
+                            sourceReader.fileContents);
+                highlightedSource = sourceHighlighter.highlightedSource;
+
+                QHighlightedSourceCache::insert(debuggerCurrentFile,
+                                                lastModified,
+                                                highlightedSource);
+
+                qDebug() << QDateTime::currentMSecsSinceEpoch()
+                         << "msecs from epoch:"
+                         << "file highlighted for Perl debugger:"
+                         << debuggerCurrentFile;
+            }
+
+            debuggerFrame->findFirstElement("#file-to-highlight")
+                    .setInnerXml("Highlighting "
+                                 + debuggerCurrentFile.toHtmlEscaped());
+            debuggerFrame->findFirstElement("#highlighted-source")
+                    .setInnerXml(highlightedSource);
+
+            debuggerDisplayedFile = debuggerCurrentFile;
+            debuggerDisplayedFileLastModified = currentFileInfo.lastModified();
+        }
 
-        qDebug() << "Perl debugger formatter error:"
-                 << debuggerOutputFormatterErrors;
+        debuggerFrame->evaluateJavaScript(
+                    QString("pebDebuggerShowLine(%1);")
+                    .arg(debuggerCurrentLine));
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "Perl debugger view updated.";
 #endif
     }
 
-    void qDebuggerHtmlFormatterFinishedSlot()
+    void qDebuggerViewLoadedSlot(bool ok)
     {
 #if PERL_DEBUGGER_INTERACTION == 1
-        debuggerFrame->setHtml(debuggerAccumulatedHtmlOutput,
-                               QUrl(PSEUDO_DOMAIN));
-
-        qDebug() << QDateTime::currentMSecsSinceEpoch()
-                 << "msecs from epoch:"
-                 << "output from Perl debugger formatter displayed.";
+        if (debuggerViewLoading == true) {
+            debuggerViewLoading = false;
 
-        debuggerOutputHandler.close();
-        debuggerAccumulatedHtmlOutput = "";
+            if (ok) {
+                qDebuggerRefreshView();
+            }
+        }
 #endif
     }
 
 public:
     QPage();
+    ~QPage();
+
+    bool interactiveScriptIsOpen()
+    {
+        return interactiveScriptHandler.isOpen();
+    }
+
+    // Pages opened by PEB itself, like profile reports,
+    // are trusted before their first request:
+    void qSetTrusted()
+    {
+        pageStatus = PageStatusTrusted;
+        emit pageStatusSignal(pageStatus);
+    }
 
 protected:
     bool acceptNavigationRequest(QWebFrame *frame,
@@ -1368,7 +3171,7 @@ protected:
 private:
     QWebView *webViewWidget;
 
-    QString pageStatus;
+    QPageStatus pageStatus;
     QRegExp htmlFileNameExtensionMarker;
     QString emptyString;
 
@@ -1387,14 +3190,35 @@ private:
     QString interactiveScriptCloseCommand;
     QString interactiveScriptClosedConfirmation;
 
+    QList<QPair<QUrl, QByteArray> > extractionWaitingScripts;
+
+#if PERL_PROFILER_INTERACTION == 1
+    QList<QPair<QUrl, QByteArray> > profiledScriptsQueue;
+#endif
+
     QWebFrame *debuggerFrame;
     bool debuggerJustStarted;
     QString debuggerScriptToDebug;
     QString debuggerLastCommand;
     QProcess debuggerHandler;
-    QString debuggerAccumulatedOutput;
-    QProcess debuggerOutputHandler;
-    QString debuggerAccumulatedHtmlOutput;
+    QTcpServer debuggerServer;
+    QTcpSocket *debuggerSocket;
+    QByteArray debuggerToken;
+    QHash<QTcpSocket *, QByteArray> debuggerHandshakes;
+    QTextDecoder *debuggerDecoder;
+    QTextDecoder *debuggerScriptDecoder;
+    QByteArray debuggerPendingCommand;
+    QDebuggerPromptScanner debuggerPromptScanner;
+    int debuggerPromptsReceived;
+    QString debuggerPendingOutput;
+    QString debuggerCurrentOutput;
+    int debuggerDisplayedOutputLength;
+    int debuggerEmptyOutputLines;
+    QString debuggerCurrentFile;
+    int debuggerCurrentLine;
+    bool debuggerViewLoading;
+    QString debuggerDisplayedFile;
+    QDateTime debuggerDisplayedFileLastModified;
 };
 
 // ==============================
@@ -1491,11 +3315,9 @@ public slots:
         QString pasteLabel;
         QString selectAllLabel;
 
-        QFileReader *resourceReader =
-                new QFileReader(QString(":/scripts/peb.js"));
-        QString pebJavaScript = resourceReader->fileContents;
-
-        mainPage->currentFrame()->evaluateJavaScript(pebJavaScript);
+        QFileReader resourceReader(QString(":/scripts/peb.js"));
+        mainPage->currentFrame()->evaluateJavaScript(
+                    resourceReader.fileContents);
 
         QVariant contextMenuJsResult =
                 mainPage->currentFrame()->
@@ -1673,6 +3495,7 @@ public slots:
     void qDisplayScriptErrorsSlot(QString errors)
     {
         errorsWindow = new QWebViewWidget();
+        errorsWindow->setAttribute(Qt::WA_DeleteOnClose);
         errorsWindow->setHtml(errors, QUrl(PSEUDO_DOMAIN));
         errorsWindow->adjustSize();
         errorsWindow->setFocus();
@@ -1683,8 +3506,13 @@ public slots:
     {
         qDebug() << "QWebInspector started.";
 
+        // The inspector is deleted when it is closed or
+        // when its inspected window is deleted:
         QWebInspector *inspector = new QWebInspector;
+        inspector->setAttribute(Qt::WA_DeleteOnClose);
         inspector->setPage(QWebViewWidget::page());
+        QObject::connect(this, SIGNAL(destroyed()),
+                         inspector, SLOT(deleteLater()));
         inspector->show();
     }
 
@@ -1713,23 +3541,45 @@ public slots:
         }
     }
 
+    // A hidden window with the loading page is kept ready
+    // for the next new window request:
+    void qPrepareSpareWindowSlot()
+    {
+        if (spareWindow != 0) {
+            return;
+        }
+
+        spareWindow = new QWebViewWidget(true);
+        spareWindow->setHtml(qLoadingPageContents());
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch: spare window prepared.";
+    }
+
 public:
-    QWebViewWidget();
+    QWebViewWidget(bool spare = false);
+    ~QWebViewWidget();
+
+    static QWebViewWidget *qTakeSpareWindow();
+    static bool qIsSpareWindow(QWebViewWidget *window);
+    static void qDeleteSpareWindow();
+    static QString qLoadingPageContents();
 
     QWebView *createWindow(QWebPage::WebWindowType type)
     {
         Q_UNUSED(type);
 
-        QFileReader *htmlReader =
-                new QFileReader(QString(":/html/loading.html"));
-        QString loadingContents = htmlReader->fileContents;
-
-        QWebView *window = new QWebViewWidget();
-        window->setHtml(loadingContents);
+        // Closed windows are deleted together with their pages:
+        QWebViewWidget *window = qTakeSpareWindow();
+        window->setAttribute(Qt::WA_DeleteOnClose);
         window->show();
 
         qDebug() << "New window opened.";
 
+        // The spare window is refilled after the new window is displayed:
+        QTimer::singleShot(SPARE_WINDOW_DELAY, this,
+                           SLOT(qPrepareSpareWindowSlot()));
+
         return window;
     }
 
@@ -1739,6 +3589,8 @@ private:
     QWebView *errorsWindow;
 
     bool windowCloseRequested;
+
+    static QWebViewWidget *spareWindow;
 };
 
 // ==============================
@@ -1751,6 +3603,12 @@ class QExitHandler : public QObject
 public slots:
     void qExitApplicationSlot()
     {
+        QWebViewWidget::qDeleteSpareWindow();
+        QApplicationArchive::qCleanup();
+#if PERL_PROFILER_INTERACTION == 1
+        QProfileReportHandler::qCleanup();
+#endif
+
         qDebug() << qApp->applicationName().toLatin1().constData()
                  << qApp->applicationVersion().toLatin1().constData()
                  << "terminated normally.";
@@ -1762,4 +3620,78 @@ public:
     QExitHandler();
 };
 
+// ==============================
+// SINGLE INSTANCE SERVER CLASS DEFINITION:
+// ==============================
+// Every further start of the browser sends its request to
+// the running instance over a local socket and exits immediately.
+// Requests are single lines with the URL to be opened and
+// only URLs from the local pseudo-domain are accepted.
+#if SINGLE_INSTANCE == 1
+class QInstanceServer : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void qNewConnectionSlot()
+    {
+        while (instanceServer.hasPendingConnections()) {
+            QLocalSocket *requestSocket = instanceServer.nextPendingConnection();
+
+            QObject::connect(requestSocket, SIGNAL(readyRead()),
+                             this, SLOT(qRequestReadSlot()));
+            QObject::connect(requestSocket, SIGNAL(disconnected()),
+                             requestSocket, SLOT(deleteLater()));
+        }
+    }
+
+    void qRequestReadSlot()
+    {
+        QLocalSocket *requestSocket = qobject_cast<QLocalSocket *>(sender());
+
+        if (requestSocket == 0 or !requestSocket->canReadLine()) {
+            return;
+        }
+
+        QUrl requestedUrl(QString::fromUtf8(
+                              requestSocket->readLine()).trimmed());
+        requestSocket->disconnectFromServer();
+
+        if (requestedUrl.authority() != PSEUDO_DOMAIN) {
+            requestedUrl = QUrl(qApp->property("startPage").toString());
+        }
+
+        qDebug() << QDateTime::currentMSecsSinceEpoch()
+                 << "msecs from epoch:"
+                 << "request from another instance received:"
+                 << requestedUrl.toString();
+
+        if (requestedUrl.isEmpty()) {
+            return;
+        }
+
+        // Closed windows are deleted together with their pages:
+        QWebViewWidget *window = QWebViewWidget::qTakeSpareWindow();
+        window->setAttribute(Qt::WA_DeleteOnClose);
+        window->setUrl(requestedUrl);
+        window->show();
+        window->raise();
+        window->activateWindow();
+
+        QTimer::singleShot(SPARE_WINDOW_DELAY, window,
+                           SLOT(qPrepareSpareWindowSlot()));
+    }
+
+public:
+    QInstanceServer();
+    bool qForwardRequest(QString request);
+    void qListen();
+
+private:
+    QString serverName;
+    QLocalServer instanceServer;
+    QLocalSocket::LocalSocketError forwardError;
+};
+#endif
+
 #endif // PEB_H
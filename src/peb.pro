@@ -107,6 +107,150 @@ equals (QT_MAJOR_VERSION, 5) {
         message ("Configured with Perl debugger interaction capability.")
     }
 
+    ##########################################################
+    # PERL PROFILER INTERACTION:
+    # To enable profiling of local Perl scripts with Devel::NYTProf:
+    # PERL_PROFILER_INTERACTION = 1
+    # By default Perl profiler interaction is enabled.
+    # To disable Perl profiler interaction:
+    # PERL_PROFILER_INTERACTION = 0
+    ##########################################################
+
+    PERL_PROFILER_INTERACTION = 1
+
+    DEFINES += "PERL_PROFILER_INTERACTION=$$PERL_PROFILER_INTERACTION"
+
+    equals (PERL_PROFILER_INTERACTION, 0) {
+        message ("Configured without Perl profiler interaction capability.")
+    }
+    equals (PERL_PROFILER_INTERACTION, 1) {
+        message ("Configured with Perl profiler interaction capability.")
+    }
+
+    ##########################################################
+    # OBJECT CACHE CAPACITY:
+    # Megabytes of the WebKit memory cache:
+    # OBJECT_CACHE_CAPACITY = 16
+    # By default 16 megabytes are used.
+    # The cache is global - it is shared by all windows and
+    # also holds cacheable resources of trusted remote domains.
+    # To disable caching of local files:
+    # OBJECT_CACHE_CAPACITY = 0
+    ##########################################################
+
+    OBJECT_CACHE_CAPACITY = 16
+
+    DEFINES += "OBJECT_CACHE_CAPACITY=$$OBJECT_CACHE_CAPACITY"
+
+    message ("Object cache capacity: $$OBJECT_CACHE_CAPACITY MB (0 - none).")
+
+    ##########################################################
+    # DISK CACHE:
+    # Megabytes of the disk cache for trusted remote domains:
+    # DISK_CACHE_SIZE = 0
+    # By default the disk cache is disabled (0).
+    ##########################################################
+
+    DISK_CACHE_SIZE = 0
+
+    DEFINES += "DISK_CACHE_SIZE=$$DISK_CACHE_SIZE"
+
+    message ("Disk cache size: $$DISK_CACHE_SIZE MB (0 - none).")
+
+    ##########################################################
+    # ASYNCHRONOUS FILE READS:
+    # Local files larger than this number of bytes are read
+    # on a thread pool and are delivered in chunks:
+    # ASYNC_READ_THRESHOLD = 1048576
+    ##########################################################
+
+    ASYNC_READ_THRESHOLD = 1048576
+
+    DEFINES += "ASYNC_READ_THRESHOLD=$$ASYNC_READ_THRESHOLD"
+
+    message ("Asynchronous file read threshold: $$ASYNC_READ_THRESHOLD bytes.")
+
+    ##########################################################
+    # PREFETCH:
+    # Maximal number of local targets linked from a trusted page,
+    # which are read in advance:
+    # PREFETCH_BUDGET = 0
+    # By default prefetching is disabled (0).
+    ##########################################################
+
+    PREFETCH_BUDGET = 0
+
+    DEFINES += "PREFETCH_BUDGET=$$PREFETCH_BUDGET"
+
+    message ("Prefetch budget: $$PREFETCH_BUDGET targets per page (0 - none).")
+
+    ##########################################################
+    # PAGE CACHE:
+    # Maximal number of trusted pages kept for back and forward navigation:
+    # PAGE_CACHE_PAGES = 0
+    # By default history and page cache are disabled (0).
+    # Memory budget of the page cache in megabytes:
+    # PAGE_CACHE_MEMORY = 32
+    ##########################################################
+
+    PAGE_CACHE_PAGES = 0
+    PAGE_CACHE_MEMORY = 32
+
+    DEFINES += "PAGE_CACHE_PAGES=$$PAGE_CACHE_PAGES"
+    DEFINES += "PAGE_CACHE_MEMORY=$$PAGE_CACHE_MEMORY"
+
+    message ("Page cache: $$PAGE_CACHE_PAGES pages (0 - none), $$PAGE_CACHE_MEMORY MB.")
+
+    ##########################################################
+    # SINGLE INSTANCE MODE:
+    # To enable single instance mode:
+    # SINGLE_INSTANCE = 1
+    # By default single instance mode is disabled.
+    # To disable single instance mode:
+    # SINGLE_INSTANCE = 0
+    # In single instance mode every further start of the binary
+    # forwards its request to the running instance and exits.
+    ##########################################################
+
+    SINGLE_INSTANCE = 0
+
+    DEFINES += "SINGLE_INSTANCE=$$SINGLE_INSTANCE"
+
+    equals (SINGLE_INSTANCE, 0) {
+        message ("Configured without single instance mode.")
+    }
+    equals (SINGLE_INSTANCE, 1) {
+        message ("Configured with single instance mode.")
+    }
+
+    ##########################################################
+    # NONINTERACTIVE SCRIPT RESOURCE LIMITS:
+    # Global wall-clock timeout in seconds:
+    # SCRIPT_TIMEOUT = 0
+    # CPU time limit in seconds:
+    # SCRIPT_CPU_TIME_LIMIT = 0
+    # Address space limit in megabytes:
+    # SCRIPT_MEMORY_LIMIT = 0
+    # By default all limits are disabled (0).
+    # CPU time and address space limits are applied
+    # using setrlimit() in the script process and
+    # are not available on Windows.
+    # A timeout requested by the 'timeout' query string item
+    # can only lower the global wall-clock timeout.
+    ##########################################################
+
+    SCRIPT_TIMEOUT = 0
+    SCRIPT_CPU_TIME_LIMIT = 0
+    SCRIPT_MEMORY_LIMIT = 0
+
+    DEFINES += "SCRIPT_TIMEOUT=$$SCRIPT_TIMEOUT"
+    DEFINES += "SCRIPT_CPU_TIME_LIMIT=$$SCRIPT_CPU_TIME_LIMIT"
+    DEFINES += "SCRIPT_MEMORY_LIMIT=$$SCRIPT_MEMORY_LIMIT"
+
+    message ("Script wall-clock timeout: $$SCRIPT_TIMEOUT seconds (0 - none).")
+    message ("Script CPU time limit: $$SCRIPT_CPU_TIME_LIMIT seconds (0 - none).")
+    message ("Script memory limit: $$SCRIPT_MEMORY_LIMIT MB (0 - none).")
+
     ##########################################################
 
     # Binary basics:
@@ -128,8 +272,10 @@ equals (QT_MAJOR_VERSION, 5) {
     QT += printsupport
 
     # Source files:
-    HEADERS += peb.h
-    SOURCES += peb.cpp
+    HEADERS += peb.h perl-syntax-highlighter.h \
+        execution-statistics.h file-index.h
+    SOURCES += peb.cpp perl-syntax-highlighter.cpp \
+        file-index.cpp
 
     # Resources:
     RESOURCES += resources/peb.qrc
@@ -138,6 +284,20 @@ equals (QT_MAJOR_VERSION, 5) {
         RC_FILE = resources/peb.rc
     }
 
+    # Packed application archive:
+    # 'make app-archive' packs resources/app in resources/app.rcc
+    APP_DIRECTORY = $$PWD/../resources/app
+    APP_ARCHIVE = $$PWD/../resources/app.rcc
+    RCC_BINARY = $$[QT_INSTALL_BINS]/rcc
+
+    app_archive.target = app-archive
+    app_archive.commands = \
+        cd $$APP_DIRECTORY && \
+        $$RCC_BINARY --project -o app.qrc && \
+        $$RCC_BINARY --binary app.qrc -o $$APP_ARCHIVE && \
+        $$QMAKE_DEL_FILE app.qrc
+    QMAKE_EXTRA_TARGETS += app_archive
+
     # Destination directory for the compiled binary:
     DESTDIR = $$PWD/../
 
@@ -0,0 +1,804 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#include <QRegExp>
+
+#include "perl-syntax-highlighter.h"
+
+// ==============================
+// PERL SYNTAX HIGHLIGHTER:
+// ==============================
+// QStringList::toSet() is deprecated since Qt 5.14,
+// so word sets are built from the word lists directly:
+static QSet<QString> perlWordSet(QString words)
+{
+    QSet<QString> wordSet;
+    foreach (QString word, words.split(" ")) {
+        wordSet.insert(word);
+    }
+    return wordSet;
+}
+
+// Word lists are taken from the Perl grammar of
+// Syntax::Highlight::Engine::Kate, so that the highlighting
+// does not drift from the one used before the native highlighter;
+// only the most common Perl operators missing there are added.
+static const QSet<QString> perlKeywords = perlWordSet(
+        "BEGIN END __DATA__ __END__ __FILE__ __LINE__ __PACKAGE__ "
+        "break continue do each else elsif for foreach if last local my "
+        "next no our package require return sub unless until use while");
+
+static const QSet<QString> perlFunctions = perlWordSet(
+        "abs accept alarm atan2 bind binmode bless caller chdir chmod "
+        "chomp chop chown chr chroot close closedir connect cos crypt "
+        "dbmclose dbmopen defined delete die dump endgrent endhostent "
+        "endnetent endprotoent endpwent endservent eof eval exec exists "
+        "exit exp fcntl fileno flock fork format formline getc getgrent "
+        "getgrgid getgrnam gethostbyaddr gethostbyname gethostent getlogin "
+        "getnetbyaddr getnetbyname getnetent getpeername getpgrp getppid "
+        "getpriority getprotobyname getprotobynumber getprotoent getpwent "
+        "getpwnam getpwuid getservbyname getservbyport getservent "
+        "getsockname getsockopt glob gmtime goto grep hex import index int "
+        "ioctl join keys kill last lc lcfirst length link listen localtime "
+        "lock log lstat map mkdir msgctl msgget msgrcv msgsnd oct open "
+        "opendir ord pack package pipe pop pos print printf prototype push "
+        "quotemeta rand read readdir readline readlink recv redo ref rename "
+        "reset return reverse rewinddir rindex rmdir scalar seek seekdir "
+        "select semctl semget semop send setgrent sethostent setnetent "
+        "setpgrp setpriority setprotoent setpwent setservent setsockopt "
+        "shift shmctl shmget shmread shmwrite shutdown sin sleep socket "
+        "socketpair sort splice split sprintf sqrt srand stat study sub "
+        "substr symlink syscall sysread sysseek system syswrite tell "
+        "telldir tie time times truncate uc ucfirst umask undef unlink "
+        "unpack unshift untie utime values vec wait waitpid wantarray warn "
+        "write");
+
+static const QSet<QString> perlPragmas = perlWordSet(
+        "bytes constant diagnostics english filetest integer less locale "
+        "open sigtrap strict subs utf8 vars warnings");
+
+static const QSet<QString> perlOperatorWords = perlWordSet(
+        "and eq ne not or");
+
+static const QSet<QString> perlOperators = perlWordSet(
+        "!= % & && &&= &= * **= *= + += , - -= -> . /= :: ; < << = => > >> "
+        "?= \\ ^ | |= || ||= ~= "
+        "=~ !~ == <= >= <=> .. ... ** / ! ? : .=");
+
+static const QSet<QString> perlQuoteLikeOperators = perlWordSet(
+        "q qq qw qx m qr s tr y");
+
+static const QSet<QString> perlSpecialVariables = perlWordSet(
+        "_ ARGV ENV INC SIG STDIN STDOUT STDERR");
+
+QPerlSyntaxHighlighter::QPerlSyntaxHighlighter(QString sourceCode)
+{
+    source = sourceCode;
+    position = 0;
+    expectTerm = true;
+    lineNumber = 0;
+
+    highlightCode();
+
+    // The last line is not terminated by a newline character:
+    if (source.length() > 0 and !source.endsWith("\n")) {
+        finishLine();
+    }
+}
+
+QChar QPerlSyntaxHighlighter::characterAt(int index)
+{
+    if (index >= 0 and index < source.length()) {
+        return source.at(index);
+    }
+    return QChar();
+}
+
+int QPerlSyntaxHighlighter::identifierEnd(int start)
+{
+    int end = start;
+    while (end < source.length()) {
+        QChar character = source.at(end);
+        if (character.isLetterOrNumber() or character == '_') {
+            end++;
+        } else if (character == ':' and characterAt(end + 1) == ':') {
+            end = end + 2;
+        } else {
+            break;
+        }
+    }
+    return end;
+}
+
+void QPerlSyntaxHighlighter::highlightCode()
+{
+    while (position < source.length()) {
+        QChar character = source.at(position);
+        bool lineStart = (position == 0 or source.at(position - 1) == '\n');
+
+        if (character == '\n') {
+            format("\n", "Normal");
+            position++;
+
+            // Here-document bodies start on the line after their markers:
+            if (heredocTerminators.length() > 0) {
+                highlightHeredocBodies();
+            }
+            continue;
+        }
+
+        // POD is highlighted as a comment up to and including
+        // the closing '=cut' line:
+        if (lineStart and character == '=' and
+                characterAt(position + 1).isLetter()) {
+            int podEnd;
+            if (source.mid(position, 4) == "=cut") {
+                podEnd = position;
+            } else {
+                podEnd = source.indexOf(QRegExp("\\n=cut\\b"), position);
+            }
+
+            if (podEnd >= 0) {
+                podEnd = source.indexOf("\n", podEnd + 1);
+            }
+
+            if (podEnd < 0) {
+                podEnd = source.length();
+            }
+
+            format(source.mid(position, podEnd - position), "Comment");
+            position = podEnd;
+            continue;
+        }
+
+        // Anything after '__END__' or '__DATA__' is not Perl code:
+        if (lineStart and (source.mid(position, 7) == "__END__" or
+                           source.mid(position, 8) == "__DATA__")) {
+            int markerEnd = identifierEnd(position);
+            format(source.mid(position, markerEnd - position), "Keyword");
+            format(source.mid(markerEnd), "Normal");
+            position = source.length();
+            continue;
+        }
+
+        if (character == ' ' or character == '\t' or character == '\r') {
+            int whitespaceEnd = position;
+            while (characterAt(whitespaceEnd) == ' ' or
+                   characterAt(whitespaceEnd) == '\t' or
+                   characterAt(whitespaceEnd) == '\r') {
+                whitespaceEnd++;
+            }
+            format(source.mid(position, whitespaceEnd - position), "Normal");
+            position = whitespaceEnd;
+            continue;
+        }
+
+        if (character == '#') {
+            int commentEnd = source.indexOf("\n", position);
+            if (commentEnd < 0) {
+                commentEnd = source.length();
+            }
+            format(source.mid(position, commentEnd - position), "Comment");
+            position = commentEnd;
+            continue;
+        }
+
+        if (character.isDigit() or
+                (character == '.' and expectTerm and
+                 characterAt(position + 1).isDigit())) {
+            highlightNumber();
+            continue;
+        }
+
+        QChar nextCharacter = characterAt(position + 1);
+        if (character == '$' or character == '@' or
+                ((character == '%' or character == '&') and expectTerm and
+                 (nextCharacter.isLetter() or nextCharacter == '_' or
+                  nextCharacter == '{' or nextCharacter == '$' or
+                  nextCharacter == ':'))) {
+            highlightVariable();
+            continue;
+        }
+
+        if (character == '\'' or character == '"' or character == '`' or
+                (character == '/' and expectTerm)) {
+            highlightQuoteLike("");
+            continue;
+        }
+
+        if (character.isLetter() or character == '_') {
+            highlightWord();
+            continue;
+        }
+
+        if (character == '<' and nextCharacter == '<') {
+            QChar markerCharacter = characterAt(position + 2);
+            if (markerCharacter == '~') {
+                markerCharacter = characterAt(position + 3);
+            }
+
+            if (markerCharacter == '"' or markerCharacter == '\'' or
+                    markerCharacter == '`' or
+                    ((markerCharacter.isLetter() or markerCharacter == '_') and
+                     expectTerm)) {
+                highlightHeredocMarker();
+                continue;
+            }
+        }
+
+        // Operators - longest match first:
+        QString perlOperator;
+        for (int length = 3; length > 0; length--) {
+            if (perlOperators.contains(source.mid(position, length))) {
+                perlOperator = source.mid(position, length);
+                break;
+            }
+        }
+
+        if (perlOperator.length() > 0) {
+            format(perlOperator, "Operator");
+            position = position + perlOperator.length();
+            expectTerm = true;
+            continue;
+        }
+
+        format(QString(character), "Normal");
+        position++;
+        expectTerm = !(character == ')' or
+                       character == ']' or
+                       character == '}');
+    }
+}
+
+void QPerlSyntaxHighlighter::highlightWord()
+{
+    int wordEnd = identifierEnd(position);
+    QString word = source.mid(position, wordEnd - position);
+
+    // Method names and hash keys are not keywords or functions:
+    int previous = position - 1;
+    while (previous >= 0 and (source.at(previous) == ' ' or
+                              source.at(previous) == '\t')) {
+        previous--;
+    }
+    bool methodName = (previous >= 1 and
+                       source.mid(previous - 1, 2) == "->");
+
+    int next = wordEnd;
+    while (characterAt(next) == ' ' or characterAt(next) == '\t') {
+        next++;
+    }
+    bool hashKey = (source.mid(next, 2) == "=>" or
+                    (characterAt(previous) == '{' and
+                     characterAt(next) == '}'));
+
+    if (methodName or hashKey) {
+        format(word, "Normal");
+        position = wordEnd;
+        expectTerm = false;
+        return;
+    }
+
+    // Quote-like operators are recognized only when
+    // followed by a valid delimiter:
+    // File test operators like '-s' are not quote-like operators.
+    if (perlQuoteLikeOperators.contains(word) and
+            characterAt(position - 1) != '-') {
+        QChar delimiter = characterAt(next);
+        if (!delimiter.isNull() and
+                !delimiter.isLetterOrNumber() and
+                delimiter != '_' and
+                !delimiter.isSpace() and
+                delimiter != ',' and
+                delimiter != ';' and
+                delimiter != ')' and
+                !(delimiter == '=' and characterAt(next + 1) == '>') and
+                !(delimiter == '#' and next > wordEnd)) {
+            format(word, "Operator");
+            format(source.mid(wordEnd, next - wordEnd), "Normal");
+            position = next;
+            highlightQuoteLike(word);
+            return;
+        }
+    }
+
+    format(word, perlKeywords.contains(word) ? "Keyword" :
+           perlFunctions.contains(word) ? "Function" :
+           perlOperatorWords.contains(word) ? "Operator" : "Normal");
+    position = wordEnd;
+    expectTerm = (perlKeywords.contains(word) or
+                  perlFunctions.contains(word) or
+                  perlOperatorWords.contains(word));
+
+    // Subroutine names and pragmas:
+    if (word == "sub" or word == "use" or word == "no") {
+        int nameEnd = identifierEnd(next);
+        if (nameEnd > next and
+                (characterAt(next).isLetter() or characterAt(next) == '_')) {
+            QString name = source.mid(next, nameEnd - next);
+            format(source.mid(wordEnd, next - wordEnd), "Normal");
+            format(name,
+                   word == "sub" ? "Function" :
+                   perlPragmas.contains(name) ? "Keyword" : "Normal");
+            position = nameEnd;
+        }
+    }
+}
+
+void QPerlSyntaxHighlighter::highlightVariable()
+{
+    QChar sigil = source.at(position);
+    int variableEnd = position + 1;
+
+    // Last index of an array:
+    if (sigil == '$' and characterAt(variableEnd) == '#' and
+            (characterAt(variableEnd + 1).isLetter() or
+             characterAt(variableEnd + 1) == '_' or
+             characterAt(variableEnd + 1) == '{' or
+             characterAt(variableEnd + 1) == '$')) {
+        variableEnd++;
+    }
+
+    // Dereferencing:
+    while (characterAt(variableEnd) == '$' and
+           (characterAt(variableEnd + 1).isLetter() or
+            characterAt(variableEnd + 1) == '_' or
+            characterAt(variableEnd + 1) == '$')) {
+        variableEnd++;
+    }
+
+    int nameStart = variableEnd;
+    variableEnd = identifierEnd(nameStart);
+    QString name = source.mid(nameStart, variableEnd - nameStart);
+
+    QString style = "DataType";
+    if (name.length() > 0) {
+        if (perlSpecialVariables.contains(name) or name.at(0).isDigit()) {
+            style = "Variable";
+        } else if (sigil == '&') {
+            style = "Function";
+        }
+    } else if (sigil == '$' and variableEnd == position + 1) {
+        QChar character = characterAt(variableEnd);
+        if (character == '^' and characterAt(variableEnd + 1).isLetter()) {
+            variableEnd = variableEnd + 2;
+            style = "Variable";
+        } else if (!character.isNull() and
+                   QString("&`'+!@/\\,;.<>~=-%:?|\"$0[]").contains(character)) {
+            variableEnd++;
+            style = "Variable";
+        } else if (character != '{') {
+            style = "Normal";
+        }
+    } else if (variableEnd == position + 1 and
+               characterAt(variableEnd) != '{') {
+        style = "Normal";
+    }
+
+    format(source.mid(position, variableEnd - position), style);
+    position = variableEnd;
+    expectTerm = false;
+}
+
+void QPerlSyntaxHighlighter::highlightNumber()
+{
+    int numberEnd = position;
+    QString style = "DecVal";
+
+    QChar prefix = characterAt(position + 1);
+    if (source.at(position) == '0' and
+            (prefix == 'x' or prefix == 'X' or
+             prefix == 'b' or prefix == 'B')) {
+        numberEnd = position + 2;
+        while (characterAt(numberEnd).isLetterOrNumber() or
+               characterAt(numberEnd) == '_') {
+            numberEnd++;
+        }
+        style = "BaseN";
+    } else if (source.at(position) == '0' and prefix.isDigit()) {
+        while (characterAt(numberEnd).isDigit() or
+               characterAt(numberEnd) == '_') {
+            numberEnd++;
+        }
+        style = "BaseN";
+    } else {
+        while (characterAt(numberEnd).isDigit() or
+               characterAt(numberEnd) == '_') {
+            numberEnd++;
+        }
+
+        if (characterAt(numberEnd) == '.' and
+                characterAt(numberEnd + 1).isDigit()) {
+            numberEnd++;
+            while (characterAt(numberEnd).isDigit() or
+                   characterAt(numberEnd) == '_') {
+                numberEnd++;
+            }
+            style = "Float";
+        }
+
+        if ((characterAt(numberEnd) == 'e' or
+             characterAt(numberEnd) == 'E') and
+                (characterAt(numberEnd + 1).isDigit() or
+                 ((characterAt(numberEnd + 1) == '+' or
+                   characterAt(numberEnd + 1) == '-') and
+                  characterAt(numberEnd + 2).isDigit()))) {
+            numberEnd = numberEnd + 2;
+            while (characterAt(numberEnd).isDigit()) {
+                numberEnd++;
+            }
+            style = "Float";
+        }
+    }
+
+    format(source.mid(position, numberEnd - position), style);
+    position = numberEnd;
+    expectTerm = false;
+}
+
+void QPerlSyntaxHighlighter::highlightQuoteLike(QString quoteOperator)
+{
+    QChar openingDelimiter = source.at(position);
+
+    // Quoted strings, patterns and transliterations:
+    bool pattern = (quoteOperator == "m" or
+                    quoteOperator == "qr" or
+                    quoteOperator == "s" or
+                    (quoteOperator.length() == 0 and
+                     openingDelimiter == '/'));
+    bool transliteration = (quoteOperator == "tr" or quoteOperator == "y");
+    bool interpolate = (openingDelimiter != '\'' and
+                        quoteOperator != "q" and
+                        quoteOperator != "qw" and
+                        !transliteration);
+    QString style = (pattern or transliteration) ? "Others" : "String";
+
+    format(QString(openingDelimiter), style);
+    int closingDelimiter = findClosingDelimiter(position + 1,
+                                                openingDelimiter);
+    highlightDelimitedBody(source.mid(position + 1,
+                                      closingDelimiter - position - 1),
+                           style, interpolate, pattern);
+
+    if (closingDelimiter >= source.length()) {
+        position = source.length();
+        return;
+    }
+
+    format(QString(source.at(closingDelimiter)), style);
+    position = closingDelimiter + 1;
+
+    // Substitutions and transliterations have a second part:
+    if (quoteOperator == "s" or transliteration) {
+        QChar secondOpeningDelimiter = openingDelimiter;
+
+        // Bracketing delimiters open the second part again:
+        if (QString("([{<").contains(openingDelimiter)) {
+            int whitespaceEnd = position;
+            while (characterAt(whitespaceEnd).isSpace()) {
+                whitespaceEnd++;
+            }
+            format(source.mid(position, whitespaceEnd - position), "Normal");
+            position = whitespaceEnd;
+
+            if (position >= source.length()) {
+                return;
+            }
+
+            secondOpeningDelimiter = source.at(position);
+            format(QString(secondOpeningDelimiter), style);
+            position++;
+        }
+
+        closingDelimiter = findClosingDelimiter(position,
+                                                secondOpeningDelimiter);
+
+        // Replacement part of a substitution is an interpolated string:
+        highlightDelimitedBody(source.mid(position,
+                                          closingDelimiter - position),
+                               transliteration ? style : "String",
+                               interpolate,
+                               false);
+
+        if (closingDelimiter >= source.length()) {
+            position = source.length();
+            return;
+        }
+
+        format(QString(source.at(closingDelimiter)), style);
+        position = closingDelimiter + 1;
+    }
+
+    // Pattern modifiers:
+    if (pattern or transliteration) {
+        int modifiersEnd = position;
+        while (characterAt(modifiersEnd).isLetter()) {
+            modifiersEnd++;
+        }
+        format(source.mid(position, modifiersEnd - position), style);
+        position = modifiersEnd;
+    }
+
+    expectTerm = false;
+}
+
+void QPerlSyntaxHighlighter::highlightHeredocMarker()
+{
+    int markerEnd = position + 2;
+    bool indented = false;
+    if (characterAt(markerEnd) == '~') {
+        indented = true;
+        markerEnd++;
+    }
+
+    format(source.mid(position, markerEnd - position), "Operator");
+    position = markerEnd;
+
+    QString terminator;
+    bool interpolate = true;
+
+    QChar quote = characterAt(position);
+    if (quote == '"' or quote == '\'' or quote == '`') {
+        int lineEnd = source.indexOf("\n", position);
+        if (lineEnd < 0) {
+            lineEnd = source.length();
+        }
+
+        int closingQuote = source.indexOf(quote, position + 1);
+        if (closingQuote < 0 or closingQuote > lineEnd) {
+            closingQuote = lineEnd;
+            markerEnd = lineEnd;
+        } else {
+            markerEnd = closingQuote + 1;
+        }
+
+        terminator = source.mid(position + 1,
+                                closingQuote - position - 1);
+        interpolate = (quote != '\'');
+    } else {
+        markerEnd = identifierEnd(position);
+        terminator = source.mid(position, markerEnd - position);
+    }
+
+    format(source.mid(position, markerEnd - position), "String");
+    position = markerEnd;
+
+    heredocTerminators.append(terminator);
+    heredocIndentation.append(indented);
+    heredocInterpolation.append(interpolate);
+
+    expectTerm = false;
+}
+
+void QPerlSyntaxHighlighter::highlightHeredocBodies()
+{
+    QStringList terminators = heredocTerminators;
+    QList<bool> indentation = heredocIndentation;
+    QList<bool> interpolation = heredocInterpolation;
+
+    heredocTerminators.clear();
+    heredocIndentation.clear();
+    heredocInterpolation.clear();
+
+    for (int heredoc = 0; heredoc < terminators.length(); heredoc++) {
+        int bodyStart = position;
+        bool terminated = false;
+
+        while (position < source.length()) {
+            int lineEnd = source.indexOf("\n", position);
+            if (lineEnd < 0) {
+                lineEnd = source.length();
+            }
+
+            QString line = source.mid(position, lineEnd - position);
+            if (line.endsWith("\r")) {
+                line.chop(1);
+            }
+            if (indentation.at(heredoc)) {
+                line.remove(QRegExp("^[ \\t]+"));
+            }
+
+            if (line == terminators.at(heredoc)) {
+                highlightDelimitedBody(source.mid(bodyStart,
+                                                  position - bodyStart),
+                                       "String",
+                                       interpolation.at(heredoc),
+                                       false);
+                format(source.mid(position, lineEnd - position), "Keyword");
+                position = lineEnd;
+
+                if (position < source.length()) {
+                    format("\n", "Normal");
+                    position++;
+                }
+
+                terminated = true;
+                break;
+            }
+
+            position = qMin(lineEnd + 1, source.length());
+        }
+
+        if (terminated == false) {
+            highlightDelimitedBody(source.mid(bodyStart),
+                                   "String",
+                                   interpolation.at(heredoc),
+                                   false);
+        }
+    }
+}
+
+void QPerlSyntaxHighlighter::highlightDelimitedBody(QString body,
+                                                    QString style,
+                                                    bool interpolate,
+                                                    bool pattern)
+{
+    QString plainText;
+    int index = 0;
+
+    while (index < body.length()) {
+        QChar character = body.at(index);
+        QChar nextCharacter;
+        if (index + 1 < body.length()) {
+            nextCharacter = body.at(index + 1);
+        }
+
+        int tokenEnd = index;
+        QString tokenStyle;
+
+        if (character == '\\' and !nextCharacter.isNull() and
+                (interpolate or pattern or
+                 nextCharacter == '\\' or nextCharacter == '\'')) {
+            // Escape sequences:
+            tokenEnd = index + 2;
+            tokenStyle = "Char";
+        } else if (interpolate and (character == '$' or character == '@') and
+                   (nextCharacter.isLetter() or nextCharacter == '_' or
+                    nextCharacter == '{' or
+                    (character == '$' and nextCharacter.isDigit()))) {
+            // Interpolated variables:
+            tokenEnd = index + 1;
+            if (nextCharacter == '{') {
+                tokenEnd = body.indexOf("}", tokenEnd);
+                tokenEnd = (tokenEnd < 0) ? body.length() : tokenEnd + 1;
+            } else {
+                while (tokenEnd < body.length() and
+                       (body.at(tokenEnd).isLetterOrNumber() or
+                        body.at(tokenEnd) == '_' or
+                        (body.at(tokenEnd) == ':' and
+                         body.mid(tokenEnd, 2) == "::"))) {
+                    tokenEnd++;
+                }
+            }
+            tokenStyle = "DataType";
+        } else if (pattern and character == '[') {
+            // Character classes:
+            tokenEnd = index + 1;
+            if (tokenEnd < body.length() and body.at(tokenEnd) == '^') {
+                tokenEnd++;
+            }
+            if (tokenEnd < body.length() and body.at(tokenEnd) == ']') {
+                tokenEnd++;
+            }
+            while (tokenEnd < body.length() and body.at(tokenEnd) != ']') {
+                if (body.at(tokenEnd) == '\\') {
+                    tokenEnd++;
+                }
+                tokenEnd++;
+            }
+            tokenEnd = qMin(tokenEnd + 1, body.length());
+            tokenStyle = "BaseN";
+        } else if (pattern and QString("()|?*+^.{}").contains(character)) {
+            // Pattern internal operators:
+            tokenEnd = index + 1;
+            tokenStyle = "Char";
+        }
+
+        if (tokenStyle.length() == 0) {
+            plainText.append(character);
+            index++;
+            continue;
+        }
+
+        if (plainText.length() > 0) {
+            format(plainText, style);
+            plainText.clear();
+        }
+
+        format(body.mid(index, tokenEnd - index), tokenStyle);
+        index = tokenEnd;
+    }
+
+    if (plainText.length() > 0) {
+        format(plainText, style);
+    }
+}
+
+int QPerlSyntaxHighlighter::findClosingDelimiter(int start,
+                                                 QChar openingDelimiter)
+{
+    QChar closingDelimiter = openingDelimiter;
+    int bracket = QString("([{<").indexOf(openingDelimiter);
+    if (bracket >= 0) {
+        closingDelimiter = QString(")]}>").at(bracket);
+    }
+
+    // Bracketing delimiters can be nested:
+    int depth = 0;
+    for (int index = start; index < source.length(); index++) {
+        QChar character = source.at(index);
+        if (character == '\\') {
+            index++;
+        } else if (character == closingDelimiter) {
+            if (depth == 0) {
+                return index;
+            }
+            depth--;
+        } else if (character == openingDelimiter) {
+            depth++;
+        }
+    }
+
+    return source.length();
+}
+
+void QPerlSyntaxHighlighter::format(QString text, QString style)
+{
+    QStringList lines = text.split("\n");
+    for (int line = 0; line < lines.length(); line++) {
+        if (line > 0) {
+            finishLine();
+        }
+
+        QString escapedText = lines.at(line);
+        escapedText.remove("\r");
+        escapedText.replace("&", "&amp;");
+        escapedText.replace("<", "&lt;");
+        escapedText.replace(">", "&gt;");
+        escapedText.replace(" ", "&nbsp;");
+        escapedText.replace("\t", "&nbsp;&nbsp;&nbsp;");
+
+        if (escapedText.length() > 0) {
+            if (style == "Normal") {
+                currentLine.append(escapedText);
+            } else if (style == currentLineStyle and
+                       currentLine.endsWith("</span>")) {
+                // Adjacent tokens of the same style share a single span:
+                currentLine.chop(7);
+                currentLine.append(escapedText + "</span>");
+            } else {
+                currentLine.append("<span class='" + style + "'>"
+                                   + escapedText + "</span>");
+            }
+            currentLineStyle = style;
+        }
+    }
+}
+
+void QPerlSyntaxHighlighter::finishLine()
+{
+    lineNumber++;
+    QString number = QString::number(lineNumber);
+
+    // Every line gets an id, so that the current line can be
+    // marked and scrolled to without highlighting the file again:
+    highlightedSource.append("<li id='line-" + number + "' value='" + number
+                             + "'><div class='line'>" + currentLine
+                             + "</div></li>\n");
+    currentLine.clear();
+    currentLineStyle.clear();
+}
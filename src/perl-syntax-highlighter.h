@@ -0,0 +1,68 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#ifndef PERL_SYNTAX_HIGHLIGHTER_H
+#define PERL_SYNTAX_HIGHLIGHTER_H
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// ==============================
+// PERL SYNTAX HIGHLIGHTER CLASS DEFINITION:
+// ==============================
+// Native tokenizer for the Perl debugger view.
+// Output is a list of HTML list items, one for every source line, and
+// tokens are marked with the style names of
+// the Syntax::Highlight::Engine::Kate Perl grammar as CSS classes.
+class QPerlSyntaxHighlighter
+{
+public:
+    QPerlSyntaxHighlighter(QString sourceCode);
+    QString highlightedSource;
+
+private:
+    void highlightCode();
+    void highlightWord();
+    void highlightVariable();
+    void highlightNumber();
+    void highlightQuoteLike(QString quoteOperator);
+    void highlightHeredocMarker();
+    void highlightHeredocBodies();
+    void highlightDelimitedBody(QString body,
+                                QString style,
+                                bool interpolate,
+                                bool pattern);
+    int findClosingDelimiter(int start, QChar openingDelimiter);
+    int identifierEnd(int start);
+    QChar characterAt(int index);
+    void format(QString text, QString style);
+    void finishLine();
+
+    QString source;
+    int position;
+    bool expectTerm;
+    QStringList heredocTerminators;
+    QList<bool> heredocIndentation;
+    QList<bool> heredocInterpolation;
+    QString currentLine;
+    QString currentLineStyle;
+    int lineNumber;
+};
+
+#endif // PERL_SYNTAX_HIGHLIGHTER_H
@@ -0,0 +1,34 @@
+# Perl Executing Browser File Index Test Project File
+
+# This program is free software;
+# you can redistribute it and/or modify it under the terms of the
+# GNU Lesser General Public License,
+# as published by the Free Software Foundation;
+# either version 3 of the License, or (at your option) any later version.
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY;
+# without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.
+# Dimitar D. Mitov, 2013 - 2016
+# Valcho Nedelchev, 2014 - 2016
+# https://github.com/ddmitov/perl-executing-browser
+
+# Build and run from this directory:
+# qmake && make check
+# The application file index is linked directly and
+# no QtWebKit libraries are needed.
+
+QT = core testlib
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_fileindex
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/file-index.h \
+    ../../src/execution-statistics.h
+
+SOURCES += tst_fileindex.cpp \
+    ../../src/file-index.cpp
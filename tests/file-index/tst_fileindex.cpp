@@ -0,0 +1,77 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#include <QtTest>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include "execution-statistics.h"
+#include "file-index.h"
+
+// Execution statistics are kept by the browser and are not tested here:
+void QExecutionStatistics::increment(QString counter, qint64 value)
+{
+    Q_UNUSED(counter);
+    Q_UNUSED(value);
+}
+
+// ==============================
+// FILE INDEX TEST CLASS DEFINITION:
+// ==============================
+// Files rewritten in place do not change their directory and
+// must still get a new size and entity tag from the index.
+class QApplicationFileIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void qRewriteInPlace()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        QString path = directory.path() + "/asset.css";
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("a");
+        file.close();
+
+        QApplicationFileIndex index(directory.path());
+        QTRY_VERIFY(index.isReady());
+
+        QSignalSpy changes(&index, SIGNAL(fileChangedSignal(QString)));
+
+        QIndexedFile indexedFile = QApplicationFileIndex::qFile(path);
+        QVERIFY(indexedFile.exists);
+        QCOMPARE(indexedFile.size, qint64(1));
+        QByteArray entityTag = indexedFile.qEntityTag();
+
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("abc");
+        file.close();
+
+        QTRY_VERIFY(changes.count() > 0);
+        QTRY_COMPARE(QApplicationFileIndex::qFile(path).size, qint64(3));
+        QVERIFY(QApplicationFileIndex::qFile(path).qEntityTag() !=
+                entityTag);
+    }
+};
+
+QTEST_GUILESS_MAIN(QApplicationFileIndexTest)
+
+#include "tst_fileindex.moc"
@@ -0,0 +1,22 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+use File::Spec;
+
+my $count = 0;
+my @lines = ('first', "second $count");
+my %options = (verbose => 1, depth => 0x1F, ratio => 3.14e-2);
+
+sub print_lines {
+    my ($self, @arguments) = @_;
+    foreach my $line (@lines) {
+        print "$line\n" if defined $line and length $line > 0;
+    }
+    return scalar @lines;
+}
+
+my $total = $#lines + 1;
+my $reference = \&print_lines;
+$self->print_lines($options{verbose});
+print STDERR "Done: $0 $total\n" unless $ENV{QUIET};
@@ -0,0 +1,16 @@
+print <<EOT;
+Hello, $name!
+Total: @{[ $count + 1 ]}
+EOT
+
+print <<'RAW', <<"COOKED";
+No $interpolation here\n
+RAW
+Interpolated $value\t
+COOKED
+
+my $indented = <<~INDENTED;
+    Indented text
+    INDENTED
+
+print $indented;
@@ -0,0 +1,23 @@
+package My::Module;
+
+our $VERSION = '1.02';
+
+=head1 NAME
+
+My::Module - a module with <documentation> & more
+
+=head1 SYNOPSIS
+
+  use My::Module;
+
+=cut
+
+sub new {
+    my $class = shift;
+    return bless {}, $class;
+}
+
+1;
+
+__DATA__
+Data lines are <not> Perl code: $not_a_variable
@@ -0,0 +1,18 @@
+my $single = q{single {nested} quote};
+my $double = qq(double $single (nested));
+my @words = qw/alpha beta gamma/;
+my $output = qx[ls -l];
+my $pattern = qr{^\s*(\w+)\s*=\s*(.*?)\s*$}x;
+
+if ($line =~ m/^([A-Z][a-z]+)\.(?:txt|pl)$/i) {
+    print "Matched: $1\n";
+}
+
+(my $copy = $line) =~ s{\\}{/}g;
+$line =~ s/(\d+)/<$1>/g;
+$line =~ tr/a-z/A-Z/;
+$line =~ y{abc}{xyz};
+
+my $ratio = $total / $count;
+my @sorted = sort { $a <=> $b } grep { /\d/ } @values;
+my $size = -s $file;
@@ -0,0 +1,37 @@
+# Perl Executing Browser Syntax Highlighter Test Project File
+
+# This program is free software;
+# you can redistribute it and/or modify it under the terms of the
+# GNU Lesser General Public License,
+# as published by the Free Software Foundation;
+# either version 3 of the License, or (at your option) any later version.
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY;
+# without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.
+# Dimitar D. Mitov, 2013 - 2016
+# Valcho Nedelchev, 2014 - 2016
+# https://github.com/ddmitov/perl-executing-browser
+
+# Build and run from this directory:
+# qmake && make check
+# The native highlighter is linked directly and
+# no QtWebKit libraries are needed.
+
+QT = core testlib
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_highlighter
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/perl-syntax-highlighter.h
+
+SOURCES += tst_highlighter.cpp \
+    ../../src/perl-syntax-highlighter.cpp
+
+# Fixtures, Kate and the Kate benchmark script are used from the source tree:
+DEFINES += "TESTS_DIRECTORY=\\\"$$PWD\\\""
+DEFINES += "PERL_LIBRARY_DIRECTORY=\\\"$$PWD/../../sdk/peblib\\\""
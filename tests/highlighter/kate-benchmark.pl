@@ -0,0 +1,56 @@
+#!/usr/bin/perl
+
+# Highlights a Perl file with Syntax::Highlight::Engine::Kate
+# line by line, the way the Perl debugger view of PEB did
+# before its native highlighter, and prints
+# the number of highlighted lines and the elapsed milliseconds.
+
+use strict;
+use warnings;
+use Syntax::Highlight::Engine::Kate;
+use Time::HiRes qw(time);
+
+my ($file_to_highlight) = @ARGV;
+
+open (my $file_to_highlight_filehandle, "<", $file_to_highlight) or
+	die "Can not open $file_to_highlight: $!\n";
+my @source_to_highlight_lines = <$file_to_highlight_filehandle>;
+close ($file_to_highlight_filehandle);
+
+my %format_table;
+foreach my $style (qw(Alert BaseN BString Char Comment DataType DecVal
+		Error Float Function IString Keyword Operator Others
+		RegionMarker Reserved String Variable Warning)) {
+	$format_table{$style} = ["<span class='${style}'>", "</span>"];
+}
+$format_table{Normal} = ["", ""];
+
+my $source_code_highlighter = new Syntax::Highlight::Engine::Kate(
+	language => "Perl",
+	substitutions => {
+		"<" => "&lt;",
+		">" => "&gt;",
+		"&" => "&amp;",
+		" " => "&nbsp;",
+		"\t" => "&nbsp;&nbsp;&nbsp;",
+		"\n" => "",
+	},
+	format_table => \%format_table,
+);
+
+my $start = time;
+
+my $line_number = 0;
+my $formatted_perl_source_code = "";
+foreach my $source_to_highlight_line (@source_to_highlight_lines) {
+	$line_number++;
+
+	$source_code_highlighter->reset();
+	my $highlighted_line =
+		$source_code_highlighter->highlightText($source_to_highlight_line);
+
+	$formatted_perl_source_code = $formatted_perl_source_code.
+		"<li id='line-${line_number}' value='${line_number}'><div class='line'>${highlighted_line}</div></li>\n";
+}
+
+printf("%d %d\n", $line_number, (time - $start) * 1000);
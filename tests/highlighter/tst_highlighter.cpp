@@ -0,0 +1,206 @@
+﻿/*
+ Perl Executing Browser
+
+ This program is free software;
+ you can redistribute it and/or modify it under the terms of the
+ GNU Lesser General Public License,
+ as published by the Free Software Foundation;
+ either version 3 of the License, or (at your option) any later version.
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY;
+ without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.
+ Dimitar D. Mitov, 2013 - 2016
+ Valcho Nedelchev, 2014 - 2016
+ https://github.com/ddmitov/perl-executing-browser
+*/
+
+#include <QtTest>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+
+#include "perl-syntax-highlighter.h"
+
+// ==============================
+// PERL SYNTAX HIGHLIGHTER TEST CLASS DEFINITION:
+// ==============================
+// Every Perl source in the 'fixtures' directory is highlighted and
+// compared with the checked-in HTML file of the same name.
+// After an intended change of the highlighting
+// the mismatching output is written next to the fixture as
+// '<name>.actual.html' and can be reviewed and copied over the old file.
+// The benchmark against Syntax::Highlight::Engine::Kate is
+// started only when the PEB_BENCHMARK environment variable is set to 1.
+class QPerlSyntaxHighlighterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void goldenOutput_data();
+    void goldenOutput();
+    void benchmarkAgainstKate();
+
+private:
+    QString readFile(QString filePath);
+    QStringList locateBenchmarkFiles();
+};
+
+QString QPerlSyntaxHighlighterTest::readFile(QString filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+
+    return QString::fromUtf8(file.readAll());
+}
+
+void QPerlSyntaxHighlighterTest::goldenOutput_data()
+{
+    QTest::addColumn<QString>("sourceFilePath");
+    QTest::addColumn<QString>("goldenFilePath");
+
+    QDir fixturesDirectory(QString(TESTS_DIRECTORY) + "/fixtures");
+    foreach (QString fixture,
+             fixturesDirectory.entryList(QStringList() << "*.pl",
+                                         QDir::Files, QDir::Name)) {
+        QString baseName = fixture;
+        baseName.chop(3);
+
+        QTest::newRow(qPrintable(baseName))
+                << fixturesDirectory.filePath(fixture)
+                << fixturesDirectory.filePath(baseName + ".html");
+    }
+}
+
+void QPerlSyntaxHighlighterTest::goldenOutput()
+{
+    QFETCH(QString, sourceFilePath);
+    QFETCH(QString, goldenFilePath);
+
+    QVERIFY2(QFile::exists(goldenFilePath), qPrintable(goldenFilePath));
+
+    QPerlSyntaxHighlighter highlighter(readFile(sourceFilePath));
+    QString expectedOutput = readFile(goldenFilePath);
+
+    if (highlighter.highlightedSource == expectedOutput) {
+        return;
+    }
+
+    QString actualFilePath = goldenFilePath;
+    actualFilePath.chop(5);
+    actualFilePath.append(".actual.html");
+    QFile actualFile(actualFilePath);
+    if (actualFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        actualFile.write(highlighter.highlightedSource.toUtf8());
+    }
+
+    // Only the first differing line is reported:
+    QStringList actualLines = highlighter.highlightedSource.split("\n");
+    QStringList expectedLines = expectedOutput.split("\n");
+    for (int line = 0;
+         line < qMax(actualLines.length(), expectedLines.length());
+         line++) {
+        QString message = QString("Line %1 differs, see %2")
+                .arg(line + 1).arg(actualFilePath);
+        QVERIFY2(actualLines.value(line) == expectedLines.value(line),
+                 qPrintable(message + "\nActual:   " +
+                            actualLines.value(line) + "\nExpected: " +
+                            expectedLines.value(line)));
+    }
+}
+
+QStringList QPerlSyntaxHighlighterTest::locateBenchmarkFiles()
+{
+    QStringList benchmarkFiles;
+
+    // Space-separated list of files to use instead of the default ones:
+    QString userFiles = QString::fromLocal8Bit(qgetenv("PEB_BENCHMARK_FILES"));
+    foreach (QString userFile, userFiles.split(" ")) {
+        if (userFile.length() > 0) {
+            benchmarkFiles.append(userFile);
+        }
+    }
+
+    if (benchmarkFiles.length() > 0) {
+        return benchmarkFiles;
+    }
+
+    // Big modules, which are part of every Perl distribution,
+    // are located in the @INC of the Perl interpreter on PATH:
+    QProcess locator;
+    locator.start("perl", QStringList()
+                  << "-e"
+                  << "foreach my $module (@ARGV) {"
+                     " foreach my $directory (@INC) {"
+                     " if (-f \"$directory/$module\") {"
+                     " print \"$directory/$module\\n\"; last; } } }"
+                  << "perl5db.pl"
+                  << "CPAN.pm"
+                  << "Math/BigInt.pm"
+                  << "Pod/Man.pm"
+                  << "Test/More.pm");
+    locator.waitForFinished();
+
+    foreach (QString locatedFile,
+             QString::fromLocal8Bit(locator.readAllStandardOutput())
+             .split("\n")) {
+        if (locatedFile.length() > 0) {
+            benchmarkFiles.append(locatedFile);
+        }
+    }
+
+    return benchmarkFiles;
+}
+
+void QPerlSyntaxHighlighterTest::benchmarkAgainstKate()
+{
+    if (qgetenv("PEB_BENCHMARK") != "1") {
+        QSKIP("Set PEB_BENCHMARK=1 to compare with "
+              "Syntax::Highlight::Engine::Kate.");
+    }
+
+    QStringList benchmarkFiles = locateBenchmarkFiles();
+    if (benchmarkFiles.length() == 0) {
+        QSKIP("No Perl files to benchmark were found.");
+    }
+
+    qDebug() << "File" << "Lines" << "Native msecs" << "Kate msecs";
+
+    foreach (QString benchmarkFile, benchmarkFiles) {
+        QString source = readFile(benchmarkFile);
+        QVERIFY2(source.length() > 0, qPrintable(benchmarkFile));
+
+        QElapsedTimer timer;
+        timer.start();
+        QPerlSyntaxHighlighter highlighter(source);
+        qint64 nativeTime = timer.elapsed();
+        QVERIFY(highlighter.highlightedSource.length() > 0);
+
+        // The Kate benchmark script prints
+        // the number of lines and the milliseconds it needed:
+        QProcess kate;
+        kate.start("perl", QStringList()
+                   << "-I" << PERL_LIBRARY_DIRECTORY
+                   << QString(TESTS_DIRECTORY) + "/kate-benchmark.pl"
+                   << benchmarkFile);
+        QVERIFY(kate.waitForFinished(-1));
+        QCOMPARE(kate.exitCode(), 0);
+
+        QStringList kateResult =
+                QString::fromLatin1(kate.readAllStandardOutput())
+                .trimmed().split(" ");
+        QCOMPARE(kateResult.length(), 2);
+
+        qDebug() << qPrintable(benchmarkFile)
+                 << kateResult.at(0).toInt()
+                 << nativeTime
+                 << kateResult.at(1).toLongLong();
+    }
+}
+
+QTEST_APPLESS_MAIN(QPerlSyntaxHighlighterTest)
+
+#include "tst_highlighter.moc"